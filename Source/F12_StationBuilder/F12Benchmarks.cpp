@@ -0,0 +1,569 @@
+// F12Benchmarks.cpp
+// Console microbenchmarks for the station data structures
+// Run from the in-game console (e.g. "F12.Bench.LatticeMap"); results go to the log
+
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "F12GridSystem.h"
+#include "F12InstancedRenderer.h"
+#include "F12FlatMap.h"
+#include "F12StationSnapshot.h"
+#include "F12ModuleStore.h"
+
+#if !UE_BUILD_SHIPPING
+
+namespace F12Bench
+{
+    // Simple wall-clock timer in milliseconds
+    struct FScopeTimer
+    {
+        double Start = FPlatformTime::Seconds();
+        double ElapsedMs() const { return (FPlatformTime::Seconds() - Start) * 1000.0; }
+    };
+
+    // Fill a roughly cubic blob with Count distinct even-parity lattice coordinates
+    static void MakeStationCoords(int32 Count, TArray<FF12GridCoord>& OutCoords)
+    {
+        OutCoords.Reset(Count);
+        const int32 Side = FMath::CeilToInt(FMath::Pow(Count * 2.0f, 1.0f / 3.0f));
+        const int32 Half = Side / 2;
+
+        for (int32 Z = 0; Z < Side && OutCoords.Num() < Count; Z++)
+        {
+            for (int32 Y = 0; Y < Side && OutCoords.Num() < Count; Y++)
+            {
+                for (int32 X = 0; X < Side && OutCoords.Num() < Count; X++)
+                {
+                    if (((X + Y + Z) & 1) == 0)
+                    {
+                        OutCoords.Add(FF12GridCoord(X - Half, Y - Half, Z - Half));
+                    }
+                }
+            }
+        }
+    }
+
+    static void Shuffle(TArray<FF12GridCoord>& Coords, int32 Seed)
+    {
+        FRandomStream Stream(Seed);
+        for (int32 i = Coords.Num() - 1; i > 0; i--)
+        {
+            Coords.Swap(i, Stream.RandRange(0, i));
+        }
+    }
+
+    // The level's instanced renderer, for benchmarks that build their own stations in it.
+    // Returns nullptr (and warns under CommandName) unless there is one and it has no modules yet.
+    static AF12InstancedRenderer* FindEmptyRenderer(UWorld* World, const TCHAR* CommandName)
+    {
+        AF12InstancedRenderer* Renderer = nullptr;
+        if (World)
+        {
+            for (TActorIterator<AF12InstancedRenderer> It(World); It; ++It)
+            {
+                Renderer = *It;
+                break;
+            }
+        }
+        if (!Renderer || Renderer->GetModuleCount() > 0)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("%s: needs an instanced renderer with no modules"), CommandName);
+            return nullptr;
+        }
+        return Renderer;
+    }
+
+    // Turns bTimeSliceRebuilds off while alive, so bulk edits and rebuilds finish inside the timed call
+    struct FScopedNoTimeSlicing
+    {
+        AF12InstancedRenderer* Renderer;
+        bool bOldTimeSlice;
+
+        explicit FScopedNoTimeSlicing(AF12InstancedRenderer* InRenderer)
+            : Renderer(InRenderer)
+            , bOldTimeSlice(InRenderer->bTimeSliceRebuilds)
+        {
+            Renderer->bTimeSliceRebuilds = false;
+        }
+
+        ~FScopedNoTimeSlicing()
+        {
+            Renderer->bTimeSliceRebuilds = bOldTimeSlice;
+        }
+    };
+
+    static void RunLatticeMapBenchmark(const TArray<FString>& Args)
+    {
+        const int32 Sizes[] = { 10000, 100000, 1000000 };
+
+        UE_LOG(LogTemp, Log, TEXT("F12 lattice map benchmark (ms): TMap<FF12GridCoord> vs TF12FlatMap<Morton key>"));
+
+        for (int32 Size : Sizes)
+        {
+            TArray<FF12GridCoord> Coords;
+            MakeStationCoords(Size, Coords);
+            Shuffle(Coords, 1234);
+
+            TArray<FF12GridCoord> Lookups = Coords;
+            Shuffle(Lookups, 5678);
+
+            int64 Sink = 0;
+
+            // --- TMap ---
+            TMap<FF12GridCoord, int32> Map;
+            FScopeTimer T0;
+            for (int32 i = 0; i < Coords.Num(); i++)
+            {
+                Map.Add(Coords[i], i);
+            }
+            const double MapInsert = T0.ElapsedMs();
+
+            FScopeTimer T1;
+            for (const FF12GridCoord& Coord : Lookups)
+            {
+                if (const int32* Found = Map.Find(Coord))
+                {
+                    Sink += *Found;
+                }
+            }
+            const double MapLookup = T1.ElapsedMs();
+
+            FScopeTimer T2;
+            for (const auto& Pair : Map)
+            {
+                Sink += Pair.Value + Pair.Key.X;
+            }
+            const double MapIterate = T2.ElapsedMs();
+
+            FScopeTimer T3;
+            for (const FF12GridCoord& Coord : Lookups)
+            {
+                Map.Remove(Coord);
+            }
+            const double MapRemove = T3.ElapsedMs();
+
+            // --- Flat map ---
+            TF12FlatMap<int32> Flat;
+            FScopeTimer T4;
+            for (int32 i = 0; i < Coords.Num(); i++)
+            {
+                Flat.Add(Coords[i].GetLatticeKey(), i);
+            }
+            const double FlatInsert = T4.ElapsedMs();
+
+            FScopeTimer T5;
+            for (const FF12GridCoord& Coord : Lookups)
+            {
+                if (const int32* Found = Flat.Find(Coord.GetLatticeKey()))
+                {
+                    Sink += *Found;
+                }
+            }
+            const double FlatLookup = T5.ElapsedMs();
+
+            FScopeTimer T6;
+            for (const auto& Pair : Flat)
+            {
+                Sink += Pair.Value + F12LatticeKey::Decode(Pair.Key).X;
+            }
+            const double FlatIterate = T6.ElapsedMs();
+
+            FScopeTimer T7;
+            Flat.ForEachSorted([&Sink](uint64 Key, int32 Value)
+            {
+                Sink += Value + F12LatticeKey::Decode(Key).X;
+            });
+            const double FlatIterateSorted = T7.ElapsedMs();
+
+            FScopeTimer T8;
+            for (const FF12GridCoord& Coord : Lookups)
+            {
+                Flat.Remove(Coord.GetLatticeKey());
+            }
+            const double FlatRemove = T8.ElapsedMs();
+
+            UE_LOG(LogTemp, Log, TEXT("  N=%7d | TMap insert %8.2f lookup %8.2f iterate %7.2f remove %8.2f | Flat insert %8.2f lookup %8.2f iterate %7.2f (sorted %7.2f) remove %8.2f | sink %lld"),
+                Coords.Num(),
+                MapInsert, MapLookup, MapIterate, MapRemove,
+                FlatInsert, FlatLookup, FlatIterate, FlatIterateSorted, FlatRemove,
+                Sink);
+        }
+    }
+
+    // Publish cost of station snapshots: first full build, then frames that touch a few bricks
+    static void RunSnapshotBenchmark(const TArray<FString>& Args)
+    {
+        const int32 Sizes[] = { 10000, 100000, 1000000 };
+        const int32 EditsPerFrame = 16;
+        const int32 NumFrames = 100;
+
+        UE_LOG(LogTemp, Log, TEXT("F12 snapshot benchmark (ms): full publish vs %d scattered edits per frame"), EditsPerFrame);
+
+        for (int32 Size : Sizes)
+        {
+            TArray<FF12GridCoord> Coords;
+            MakeStationCoords(Size, Coords);
+
+            FF12OccupancyStore Occupancy;
+            FF12SnapshotPublisher Publisher;
+            for (const FF12GridCoord& Coord : Coords)
+            {
+                Occupancy.Set(Coord.ToIntVector());
+                Publisher.MarkDirty(Coord.ToIntVector());
+            }
+
+            const auto FillChunk = [&Occupancy](const FIntVector& BrickCoord, FF12SnapshotChunk& OutChunk)
+            {
+                if (const FF12OccupancyBrick* Brick = Occupancy.FindBrick(BrickCoord))
+                {
+                    OutChunk.Cells = *Brick;
+                    OutChunk.Modules.SetNum(Brick->Count);
+                }
+            };
+
+            FScopeTimer T0;
+            Publisher.Publish(FillChunk);
+            const double FullMs = T0.ElapsedMs();
+
+            // Readers keep old versions alive while new ones are published
+            TArray<FF12StationSnapshotRef> Held;
+            FRandomStream Stream(99);
+
+            FScopeTimer T1;
+            for (int32 Frame = 0; Frame < NumFrames; Frame++)
+            {
+                for (int32 Edit = 0; Edit < EditsPerFrame; Edit++)
+                {
+                    const FIntVector Cell = Coords[Stream.RandHelper(Coords.Num())].ToIntVector();
+                    Occupancy.Clear(Cell);
+                    Occupancy.Set(Cell);
+                    Publisher.MarkDirty(Cell);
+                }
+                Publisher.Publish(FillChunk);
+                Held.Add(Publisher.GetLatest());
+            }
+            const double FrameMs = T1.ElapsedMs() / NumFrames;
+
+            const FF12StationSnapshotRef Latest = Publisher.GetLatest();
+            UE_LOG(LogTemp, Log, TEXT("  N=%7d | chunks %6d | full publish %8.2f | per-frame publish %6.3f | version %llu, %d modules"),
+                Coords.Num(), Latest->NumChunks(), FullMs, FrameMs, Latest->GetVersion(), Latest->Num());
+        }
+    }
+
+    // Single-tile repaint and single-module delete latency as the rendered station grows.
+    // Uses the level's renderer, so it needs an empty station to start from.
+    static void RunModuleEditsBenchmark(const TArray<FString>& Args, UWorld* World)
+    {
+        AF12InstancedRenderer* Renderer = FindEmptyRenderer(World, TEXT("F12.Bench.ModuleEdits"));
+        if (!Renderer)
+            return;
+
+        const int32 Sizes[] = { 1000, 5000, 20000, 50000 };
+        const int32 NumEdits = 100;
+
+        // Build each station fully inside AddModulesBulk
+        FScopedNoTimeSlicing NoTimeSlicing(Renderer);
+
+        UE_LOG(LogTemp, Log, TEXT("F12 module edit benchmark (ms): %d tile repaints and %d module deletes per station size"), NumEdits, NumEdits);
+
+        for (int32 Size : Sizes)
+        {
+            TArray<FF12GridCoord> Coords;
+            MakeStationCoords(Size, Coords);
+
+            FScopeTimer T0;
+            Renderer->AddModulesBulk(Coords);
+            const double BuildMs = T0.ElapsedMs();
+
+            Shuffle(Coords, 42);
+
+            FScopeTimer T1;
+            for (int32 i = 0; i < NumEdits; i++)
+            {
+                Renderer->SetTileMaterial(Coords[i], i % F12Lattice::NumFaces, 1);
+            }
+            const double PaintMs = T1.ElapsedMs() / NumEdits;
+
+            FScopeTimer T2;
+            for (int32 i = 0; i < NumEdits; i++)
+            {
+                Renderer->RemoveModule(Coords[i]);
+            }
+            const double DeleteMs = T2.ElapsedMs() / NumEdits;
+
+            UE_LOG(LogTemp, Log, TEXT("  N=%6d | full rebuild %8.2f | per repaint %7.4f | per delete %7.4f | %d tiles left"),
+                Coords.Num(), BuildMs, PaintMs, DeleteMs, Renderer->GetTotalInstanceCount());
+
+            Renderer->ClearAll();
+        }
+    }
+
+    // Full instance rebuild time at 10k and 100k modules, with the transform kernel on worker
+    // threads and forced onto the game thread (F12.Render.ParallelRebuild)
+    static void RunRebuildBenchmark(const TArray<FString>& Args, UWorld* World)
+    {
+        AF12InstancedRenderer* Renderer = FindEmptyRenderer(World, TEXT("F12.Bench.Rebuild"));
+        if (!Renderer)
+            return;
+
+        IConsoleVariable* ParallelVar = IConsoleManager::Get().FindConsoleVariable(TEXT("F12.Render.ParallelRebuild"));
+        if (!ParallelVar)
+            return;
+        const int32 OldParallel = ParallelVar->GetInt();
+
+        // Time the whole rebuild in one call, not the first slice of it
+        FScopedNoTimeSlicing NoTimeSlicing(Renderer);
+
+        const int32 Sizes[] = { 10000, 100000 };
+        const int32 NumRuns = 3;
+
+        UE_LOG(LogTemp, Log, TEXT("F12 rebuild benchmark (ms, average of %d rebuilds)"), NumRuns);
+
+        for (int32 Size : Sizes)
+        {
+            TArray<FF12GridCoord> Coords;
+            MakeStationCoords(Size, Coords);
+
+            FScopeTimer T0;
+            Renderer->AddModulesBulk(Coords);
+            const double AddMs = T0.ElapsedMs();
+
+            double RebuildMs[2] = {};
+            for (int32 Parallel = 0; Parallel < 2; Parallel++)
+            {
+                // One untimed rebuild first, so neither mode pays for the other's allocations
+                ParallelVar->Set(Parallel, ECVF_SetByCode);
+                Renderer->RebuildInstances();
+
+                FScopeTimer T1;
+                for (int32 Run = 0; Run < NumRuns; Run++)
+                {
+                    Renderer->RebuildInstances();
+                }
+                RebuildMs[Parallel] = T1.ElapsedMs() / NumRuns;
+            }
+
+            UE_LOG(LogTemp, Log, TEXT("  N=%6d | bulk add %8.2f | rebuild game thread %8.2f | rebuild parallel %8.2f | speedup %5.2fx | %d tiles, %d chunks"),
+                Coords.Num(), AddMs, RebuildMs[0], RebuildMs[1], RebuildMs[0] / FMath::Max(RebuildMs[1], 0.001),
+                Renderer->GetTotalInstanceCount(), Renderer->GetChunkCount());
+
+            Renderer->ClearAll();
+        }
+
+        ParallelVar->Set(OldParallel, ECVF_SetByCode);
+    }
+
+    // Per-module record as the renderer stored it before FF12ModuleStore (two heap arrays per module)
+    struct FLegacyModuleData
+    {
+        TArray<int32> TileMaterials;
+        TArray<bool> TileVisibility;
+        int32 InstanceIndices[12];
+        uint16 CulledFaces = 0;
+        uint16 ColoredTiles = 0;
+        uint32 TileColors[12];
+
+        FLegacyModuleData()
+        {
+            TileMaterials.SetNum(12);
+            TileVisibility.SetNum(12);
+            for (int32 i = 0; i < 12; i++)
+            {
+                TileMaterials[i] = 0;
+                TileVisibility[i] = true;
+                InstanceIndices[i] = INDEX_NONE;
+                TileColors[i] = 0;
+            }
+        }
+    };
+
+    static void RunModuleMemoryBenchmark(const TArray<FString>& Args)
+    {
+        const int32 NumModules = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 100000;
+
+        TArray<FF12GridCoord> Coords;
+        MakeStationCoords(NumModules, Coords);
+        Shuffle(Coords, 1234);
+
+        int64 Sink = 0;
+
+        // --- Before: flat map of FLegacyModuleData ---
+        TF12FlatMap<FLegacyModuleData> Legacy;
+        FScopeTimer T0;
+        for (int32 i = 0; i < Coords.Num(); i++)
+        {
+            FLegacyModuleData& Data = Legacy.Add(Coords[i].GetLatticeKey(), FLegacyModuleData());
+            Data.TileMaterials[i % 12] = 1;
+        }
+        const double LegacyFill = T0.ElapsedMs();
+
+        SIZE_T LegacyBytes = Legacy.GetAllocatedSize();
+        for (const auto& Pair : Legacy)
+        {
+            LegacyBytes += Pair.Value.TileMaterials.GetAllocatedSize() + Pair.Value.TileVisibility.GetAllocatedSize();
+        }
+
+        FScopeTimer T1;
+        for (const auto& Pair : Legacy)
+        {
+            for (int32 Tile = 0; Tile < 12; Tile++)
+            {
+                Sink += Pair.Value.TileVisibility[Tile] ? Pair.Value.TileMaterials[Tile] : 0;
+            }
+        }
+        const double LegacyScan = T1.ElapsedMs();
+
+        // --- After: FF12ModuleStore ---
+        FF12ModuleStore Store;
+        FScopeTimer T2;
+        Store.Reserve(Coords.Num());
+        for (int32 i = 0; i < Coords.Num(); i++)
+        {
+            const int32 Slot = Store.Add(Coords[i].ToIntVector(), 0);
+            Store.SetMaterial(Slot, i % 12, 1);
+        }
+        const double StoreFill = T2.ElapsedMs();
+
+        const SIZE_T StoreBytes = Store.GetAllocatedSize();
+
+        FScopeTimer T3;
+        Store.ForEach([&Store, &Sink](int32 Slot)
+        {
+            const uint16 Visible = Store.GetVisibleMask(Slot);
+            for (int32 Tile = 0; Tile < 12; Tile++)
+            {
+                Sink += (Visible & (1 << Tile)) ? Store.GetMaterial(Slot, Tile) : 0;
+            }
+        });
+        const double StoreScan = T3.ElapsedMs();
+
+        UE_LOG(LogTemp, Log, TEXT("F12 module memory report: %d modules (heap bytes from GetAllocatedSize, allocator overhead not included)"), Coords.Num());
+        UE_LOG(LogTemp, Log, TEXT("  Before (flat map + 2 TArrays/module): %8.2f MB (%6.1f B/module, %d extra heap blocks) fill %7.2f ms, scan %6.2f ms"),
+            LegacyBytes / (1024.0 * 1024.0), (double)LegacyBytes / Coords.Num(), Coords.Num() * 2, LegacyFill, LegacyScan);
+        UE_LOG(LogTemp, Log, TEXT("  After  (FF12ModuleStore):             %8.2f MB (%6.1f B/module,   no per-module blocks) fill %7.2f ms, scan %6.2f ms (sink %lld)"),
+            StoreBytes / (1024.0 * 1024.0), (double)StoreBytes / Coords.Num(), StoreFill, StoreScan, Sink);
+    }
+
+    // Cast random rays at the live station and compare the grid raycast with a physics line trace.
+    // The trace only hits tiles when the renderer has bEnableTileCollision set.
+    static void RunPickingBenchmark(const TArray<FString>& Args, UWorld* World)
+    {
+        if (!World)
+            return;
+
+        AF12GridSystem* Grid = nullptr;
+        for (TActorIterator<AF12GridSystem> It(World); It; ++It)
+        {
+            Grid = *It;
+            break;
+        }
+        if (!Grid || Grid->GetOccupiedCount() == 0)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("F12.Bench.Picking: no grid system with modules in this world"));
+            return;
+        }
+
+        // Without tile collision the line traces would run against an empty scene
+        bool bTileCollision = false;
+        for (TActorIterator<AF12InstancedRenderer> It(World); It; ++It)
+        {
+            bTileCollision = It->bEnableTileCollision;
+            break;
+        }
+        if (!bTileCollision)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("F12.Bench.Picking: needs bEnableTileCollision on the instanced renderer (set before play)"));
+            return;
+        }
+
+        const int32 NumRays = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 10000;
+
+        // Aim from a shell around the station's bounds towards random occupied modules
+        const TArray<FF12GridCoord> Cells = Grid->GetOccupiedCells();
+        FBox Bounds(ForceInit);
+        for (const FF12GridCoord& Cell : Cells)
+        {
+            Bounds += Grid->GridToWorld(Cell);
+        }
+        const FVector Center = Bounds.GetCenter();
+        const double Radius = Bounds.GetExtent().Size() + Grid->GetAdjustedSpacing() * 4.0;
+        const float MaxDistance = (float)(Radius * 2.0);
+
+        FRandomStream Stream(4321);
+        TArray<FVector> Origins, Directions;
+        Origins.SetNum(NumRays);
+        Directions.SetNum(NumRays);
+        for (int32 i = 0; i < NumRays; i++)
+        {
+            Origins[i] = Center + Stream.VRand() * Radius;
+            const FVector Target = Grid->GridToWorld(Cells[Stream.RandHelper(Cells.Num())]);
+            Directions[i] = (Target - Origins[i]).GetSafeNormal();
+        }
+
+        int32 LatticeHits = 0;
+        FScopeTimer T0;
+        for (int32 i = 0; i < NumRays; i++)
+        {
+            FF12LatticeHit Hit;
+            if (Grid->RaycastModules(Origins[i], Directions[i], MaxDistance, Hit))
+            {
+                LatticeHits++;
+            }
+        }
+        const double LatticeMs = T0.ElapsedMs();
+
+        int32 TraceHits = 0;
+        FCollisionQueryParams Params(SCENE_QUERY_STAT(F12BenchPicking), true);
+        FScopeTimer T1;
+        for (int32 i = 0; i < NumRays; i++)
+        {
+            FHitResult Hit;
+            if (World->LineTraceSingleByChannel(Hit, Origins[i], Origins[i] + Directions[i] * MaxDistance, ECC_Visibility, Params))
+            {
+                TraceHits++;
+            }
+        }
+        const double TraceMs = T1.ElapsedMs();
+
+        UE_LOG(LogTemp, Log, TEXT("F12 picking benchmark: %d rays, %d modules"), NumRays, Cells.Num());
+        UE_LOG(LogTemp, Log, TEXT("  RaycastModules %8.2f ms (%6.2f us/ray, %d hits) | LineTrace %8.2f ms (%6.2f us/ray, %d hits)"),
+            LatticeMs, LatticeMs * 1000.0 / NumRays, LatticeHits,
+            TraceMs, TraceMs * 1000.0 / NumRays, TraceHits);
+    }
+}
+
+static FAutoConsoleCommand GF12BenchLatticeMapCommand(
+    TEXT("F12.Bench.LatticeMap"),
+    TEXT("Compare TMap<FF12GridCoord> with TF12FlatMap for insert/lookup/iterate/remove at 10k, 100k and 1M modules"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&F12Bench::RunLatticeMapBenchmark));
+
+static FAutoConsoleCommand GF12BenchSnapshotCommand(
+    TEXT("F12.Bench.Snapshot"),
+    TEXT("Time a full station snapshot publish and incremental publishes with a few edited bricks per frame"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&F12Bench::RunSnapshotBenchmark));
+
+static FAutoConsoleCommand GF12BenchModuleEditsCommand(
+    TEXT("F12.Bench.ModuleEdits"),
+    TEXT("Time single-tile repaints and single-module deletes on rendered stations of 1k to 50k modules (run with an empty station)"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&F12Bench::RunModuleEditsBenchmark));
+
+static FAutoConsoleCommand GF12BenchRebuildCommand(
+    TEXT("F12.Bench.Rebuild"),
+    TEXT("Time a full instance rebuild at 10k and 100k modules, parallel vs game-thread transform building (run with an empty station)"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&F12Bench::RunRebuildBenchmark));
+
+static FAutoConsoleCommand GF12BenchModuleMemoryCommand(
+    TEXT("F12.Bench.ModuleMemory"),
+    TEXT("Report memory and scan time of the per-module tile records, old per-module TArrays vs FF12ModuleStore. Optional arg: module count (default 100000)"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&F12Bench::RunModuleMemoryBenchmark));
+
+static FAutoConsoleCommand GF12BenchPickingCommand(
+    TEXT("F12.Bench.Picking"),
+    TEXT("Time AF12GridSystem::RaycastModules against a physics line trace over the current station (needs bEnableTileCollision). Optional arg: ray count (default 10000)"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&F12Bench::RunPickingBenchmark));
+
+#endif // !UE_BUILD_SHIPPING
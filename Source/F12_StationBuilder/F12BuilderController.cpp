@@ -160,47 +160,36 @@ void AF12BuilderController::Tick(float DeltaTime)
     // Handle drag painting in paint mode
     if (bIsPainting && CurrentMode == EF12BuilderMode::Paint && InstancedRenderer)
     {
-        FHitResult Hit;
-        if (TraceFromCamera(Hit))
+        FF12GridCoord HitGridCoord;
+        int32 TileIndex;
+        
+        if (PickModuleFromCamera(HitGridCoord, TileIndex))
         {
-            FF12GridCoord HitGridCoord;
-            int32 TileIndex;
+            bool bShouldPaint = false;
             
-            if (InstancedRenderer->GetHitModuleAndTile(Hit, HitGridCoord, TileIndex))
+            if (bModifierHeld)
             {
-                bool bShouldPaint = false;
-                
-                if (bModifierHeld)
-                {
-                    // Single tile mode - check if different tile
-                    if (!(HitGridCoord == LastPaintedCoord && TileIndex == LastPaintedTile))
-                    {
-                        bShouldPaint = true;
-                    }
-                }
-                else
+                // Single tile mode - check if different tile
+                if (!(HitGridCoord == LastPaintedCoord && TileIndex == LastPaintedTile))
                 {
-                    // Module mode - check if different module
-                    if (!(HitGridCoord == LastPaintedCoord))
-                    {
-                        bShouldPaint = true;
-                    }
+                    bShouldPaint = true;
                 }
-                
-                if (bShouldPaint)
+            }
+            else
+            {
+                // Module mode - check if different module
+                if (!(HitGridCoord == LastPaintedCoord))
                 {
-                    if (bModifierHeld)
-                    {
-                        InstancedRenderer->SetTileMaterial(HitGridCoord, TileIndex, CurrentPaintMaterialIndex);
-                    }
-                    else
-                    {
-                        InstancedRenderer->SetModuleMaterial(HitGridCoord, CurrentPaintMaterialIndex);
-                    }
-                    LastPaintedCoord = HitGridCoord;
-                    LastPaintedTile = TileIndex;
+                    bShouldPaint = true;
                 }
             }
+            
+            if (bShouldPaint)
+            {
+                ApplyPaint(HitGridCoord, TileIndex, bModifierHeld);
+                LastPaintedCoord = HitGridCoord;
+                LastPaintedTile = TileIndex;
+            }
         }
     }
     
@@ -264,32 +253,29 @@ void AF12BuilderController::OnPrimaryAction()
         // Only start drag if shift is held
         if (bModifierHeld)
         {
-            FHitResult Hit;
-            if (TraceFromCamera(Hit) && InstancedRenderer && GridSystem)
+            FF12GridCoord HitGridCoord;
+            int32 TileIndex;
+            FVector HitLocation;
+            
+            if (InstancedRenderer && GridSystem && PickModuleFromCamera(HitGridCoord, TileIndex, &HitLocation))
             {
-                FF12GridCoord HitGridCoord;
-                int32 TileIndex;
+                // Get the neighbor coord and direction for this face
+                DragStartCoord = GridSystem->GetNeighborCoordForFace(HitGridCoord, TileIndex);
+                DragFaceIndex = TileIndex;
+                
+                // Get the face normal direction from the grid system
+                DragDirection = GridSystem->GetFaceNormal(TileIndex);
                 
-                if (InstancedRenderer->GetHitModuleAndTile(Hit, HitGridCoord, TileIndex))
+                // Store the world position where we started dragging
+                DragStartWorldPos = HitLocation;
+                
+                // Only start drag if the start position is valid
+                if (!GridSystem->IsOccupied(DragStartCoord))
                 {
-                    // Get the neighbor coord and direction for this face
-                    DragStartCoord = GridSystem->GetNeighborCoordForFace(HitGridCoord, TileIndex);
-                    DragFaceIndex = TileIndex;
-                    
-                    // Get the face normal direction from the grid system
-                    DragDirection = GridSystem->GetFaceNormal(TileIndex);
-                    
-                    // Store the world position where we started dragging
-                    DragStartWorldPos = Hit.ImpactPoint;
-                    
-                    // Only start drag if the start position is valid
-                    if (!GridSystem->IsOccupied(DragStartCoord))
-                    {
-                        bIsDragging = true;
-                        DragPreviewCoords.Empty();
-                        DragPreviewCoords.Add(DragStartCoord);
-                        UE_LOG(LogTemp, Log, TEXT("Started drag from face %d, direction: %s"), TileIndex, *DragDirection.ToString());
-                    }
+                    bIsDragging = true;
+                    DragPreviewCoords.Empty();
+                    DragPreviewCoords.Add(DragStartCoord);
+                    UE_LOG(LogTemp, Log, TEXT("Started drag from face %d, direction: %s"), TileIndex, *DragDirection.ToString());
                 }
             }
         }
@@ -360,6 +346,7 @@ void AF12BuilderController::OnCyclePaint()
 {
     if (PaintColors.Num() > 0)
     {
+        bUseCustomPaintColor = false;
         CurrentPaintMaterialIndex = (CurrentPaintMaterialIndex + 1) % PaintColors.Num();
         UE_LOG(LogTemp, Log, TEXT("Paint material cycled to: %d"), CurrentPaintMaterialIndex);
     }
@@ -421,10 +408,23 @@ void AF12BuilderController::CyclePaintMaterial()
 {
     if (PaintColors.Num() > 0)
     {
+        bUseCustomPaintColor = false;
         CurrentPaintMaterialIndex = (CurrentPaintMaterialIndex + 1) % PaintColors.Num();
     }
 }
 
+void AF12BuilderController::SetCustomPaintColor(FLinearColor Color, float Roughness)
+{
+    CustomPaintColor = Color;
+    CustomPaintRoughness = FMath::Clamp(Roughness, 0.0f, 1.0f);
+    bUseCustomPaintColor = true;
+}
+
+void AF12BuilderController::UsePalettePaint()
+{
+    bUseCustomPaintColor = false;
+}
+
 // === MODE-SPECIFIC HANDLERS ===
 
 void AF12BuilderController::HandleBuildPrimary()
@@ -443,30 +443,46 @@ void AF12BuilderController::HandlePaintPrimary()
     if (!InstancedRenderer)
         return;
 
-    FHitResult Hit;
-    if (TraceFromCamera(Hit))
+    FF12GridCoord GridCoord;
+    int32 TileIndex;
+    
+    if (PickModuleFromCamera(GridCoord, TileIndex))
     {
-        FF12GridCoord GridCoord;
-        int32 TileIndex;
-        
-        if (InstancedRenderer->GetHitModuleAndTile(Hit, GridCoord, TileIndex))
+        ApplyPaint(GridCoord, TileIndex, bModifierHeld);
+        if (bUseCustomPaintColor)
         {
-            if (bModifierHeld)
-            {
-                // Paint single tile
-                InstancedRenderer->SetTileMaterial(GridCoord, TileIndex, CurrentPaintMaterialIndex);
-                UE_LOG(LogTemp, Log, TEXT("Painted tile %d with material %d"), TileIndex, CurrentPaintMaterialIndex);
-            }
-            else
-            {
-                // Paint whole module
-                InstancedRenderer->SetModuleMaterial(GridCoord, CurrentPaintMaterialIndex);
-                UE_LOG(LogTemp, Log, TEXT("Painted module with material %d"), CurrentPaintMaterialIndex);
-            }
+            UE_LOG(LogTemp, Log, TEXT("Painted %s with colour %s"), bModifierHeld ? TEXT("tile") : TEXT("module"), *CustomPaintColor.ToString());
+        }
+        else
+        {
+            UE_LOG(LogTemp, Log, TEXT("Painted %s with material %d"), bModifierHeld ? TEXT("tile") : TEXT("module"), CurrentPaintMaterialIndex);
         }
     }
 }
 
+void AF12BuilderController::ApplyPaint(FF12GridCoord GridCoord, int32 TileIndex, bool bSingleTile)
+{
+    if (bUseCustomPaintColor)
+    {
+        if (bSingleTile)
+        {
+            InstancedRenderer->SetTileColor(GridCoord, TileIndex, CustomPaintColor, CustomPaintRoughness);
+        }
+        else
+        {
+            InstancedRenderer->SetModuleColor(GridCoord, CustomPaintColor, CustomPaintRoughness);
+        }
+    }
+    else if (bSingleTile)
+    {
+        InstancedRenderer->SetTileMaterial(GridCoord, TileIndex, CurrentPaintMaterialIndex);
+    }
+    else
+    {
+        InstancedRenderer->SetModuleMaterial(GridCoord, CurrentPaintMaterialIndex);
+    }
+}
+
 void AF12BuilderController::HandlePaintSecondary()
 {
     CyclePaintMaterial();
@@ -477,34 +493,38 @@ void AF12BuilderController::HandleDeletePrimary()
     if (!InstancedRenderer || !GridSystem)
         return;
 
-    FHitResult Hit;
-    if (TraceFromCamera(Hit))
+    FF12GridCoord GridCoord;
+    int32 TileIndex;
+    
+    if (PickModuleFromCamera(GridCoord, TileIndex))
     {
-        FF12GridCoord GridCoord;
-        int32 TileIndex;
-        
-        if (InstancedRenderer->GetHitModuleAndTile(Hit, GridCoord, TileIndex))
+        if (bModifierHeld)
         {
-            if (bModifierHeld)
+            // Delete single tile (hide it)
+            InstancedRenderer->SetTileVisible(GridCoord, TileIndex, false);
+            UE_LOG(LogTemp, Log, TEXT("Hid tile %d"), TileIndex);
+        }
+        else
+        {
+            // Can't delete core
+            if (GridCoord.X == 0 && GridCoord.Y == 0 && GridCoord.Z == 0)
             {
-                // Delete single tile (hide it)
-                InstancedRenderer->SetTileVisible(GridCoord, TileIndex, false);
-                UE_LOG(LogTemp, Log, TEXT("Hid tile %d"), TileIndex);
+                UE_LOG(LogTemp, Warning, TEXT("Cannot delete core module"));
+                return;
             }
-            else
+
+            // Optionally refuse deletes that would leave modules floating
+            if (GridSystem->bPreventStationSplit && GridSystem->WouldRemovalSplit(GridCoord))
             {
-                // Can't delete core
-                if (GridCoord.X == 0 && GridCoord.Y == 0 && GridCoord.Z == 0)
-                {
-                    UE_LOG(LogTemp, Warning, TEXT("Cannot delete core module"));
-                    return;
-                }
-                
-                // Delete whole module
-                InstancedRenderer->RemoveModule(GridCoord);
-                GridSystem->ClearOccupied(GridCoord);
-                UE_LOG(LogTemp, Log, TEXT("Deleted module at (%d, %d, %d)"), GridCoord.X, GridCoord.Y, GridCoord.Z);
+                UE_LOG(LogTemp, Warning, TEXT("Cannot delete module at (%d, %d, %d): station would split"),
+                    GridCoord.X, GridCoord.Y, GridCoord.Z);
+                return;
             }
+            
+            // Delete whole module
+            InstancedRenderer->RemoveModule(GridCoord);
+            GridSystem->ClearOccupied(GridCoord);
+            UE_LOG(LogTemp, Log, TEXT("Deleted module at (%d, %d, %d)"), GridCoord.X, GridCoord.Y, GridCoord.Z);
         }
     }
 }
@@ -515,19 +535,15 @@ void AF12BuilderController::HandleDeleteSecondary()
     if (!InstancedRenderer)
         return;
 
-    FHitResult Hit;
-    if (TraceFromCamera(Hit))
+    FF12GridCoord GridCoord;
+    int32 TileIndex;
+    
+    if (PickModuleFromCamera(GridCoord, TileIndex))
     {
-        FF12GridCoord GridCoord;
-        int32 TileIndex;
-        
-        if (InstancedRenderer->GetHitModuleAndTile(Hit, GridCoord, TileIndex))
+        if (!InstancedRenderer->GetTileVisible(GridCoord, TileIndex))
         {
-            if (!InstancedRenderer->GetTileVisible(GridCoord, TileIndex))
-            {
-                InstancedRenderer->SetTileVisible(GridCoord, TileIndex, true);
-                UE_LOG(LogTemp, Log, TEXT("Restored tile %d"), TileIndex);
-            }
+            InstancedRenderer->SetTileVisible(GridCoord, TileIndex, true);
+            UE_LOG(LogTemp, Log, TEXT("Restored tile %d"), TileIndex);
         }
     }
 }
@@ -557,6 +573,38 @@ bool AF12BuilderController::TraceFromCamera(FHitResult& OutHit)
     return false;
 }
 
+bool AF12BuilderController::PickModuleFromCamera(FF12GridCoord& OutGridCoord, int32& OutTileIndex, FVector* OutHitLocation)
+{
+    if (!GridSystem)
+        return false;
+
+    FVector WorldLocation, WorldDirection;
+    if (!DeprojectMousePositionToWorld(WorldLocation, WorldDirection))
+        return false;
+
+    // Walk the lattice directly; needs no collision on the tiles.
+    // Hidden tiles can be clicked through, like the tile collision used to allow.
+    const AF12InstancedRenderer* Renderer = InstancedRenderer;
+    const auto IsFaceSolid = [Renderer](const FF12GridCoord& Coord, int32 Face)
+    {
+        return !Renderer || Renderer->GetTileVisible(Coord, Face);
+    };
+
+    FF12LatticeHit LatticeHit;
+    if (GridSystem->RaycastModulesFiltered(WorldLocation, WorldDirection, TraceDistance, LatticeHit, IsFaceSolid))
+    {
+        OutGridCoord = LatticeHit.Coord;
+        OutTileIndex = LatticeHit.FaceIndex;
+        if (OutHitLocation)
+        {
+            *OutHitLocation = LatticeHit.Location;
+        }
+        return true;
+    }
+
+    return false;
+}
+
 void AF12BuilderController::UpdatePreview()
 {
     if (!GridSystem || !InstancedRenderer)
@@ -572,25 +620,21 @@ void AF12BuilderController::UpdatePreview()
         return;
     }
 
+    FF12GridCoord HitGridCoord;
+    int32 TileIndex;
     FHitResult Hit;
     
-    if (TraceFromCamera(Hit))
+    // Check if we hit an existing module
+    if (PickModuleFromCamera(HitGridCoord, TileIndex))
     {
-        FF12GridCoord HitGridCoord;
-        int32 TileIndex;
-        
-        // Check if we hit an existing module
-        if (InstancedRenderer->GetHitModuleAndTile(Hit, HitGridCoord, TileIndex))
-        {
-            // Get the neighbor coord for the hit face
-            CurrentGridCoord = GridSystem->GetNeighborCoordForFace(HitGridCoord, TileIndex);
-        }
-        else
-        {
-            // Hit something else, use grid position
-            CurrentGridCoord = GridSystem->WorldToGrid(Hit.Location);
-        }
-        
+        // Get the neighbor coord for the hit face
+        CurrentGridCoord = GridSystem->GetNeighborCoordForFace(HitGridCoord, TileIndex);
+        bValidPlacement = !GridSystem->IsOccupied(CurrentGridCoord);
+    }
+    else if (TraceFromCamera(Hit))
+    {
+        // Hit something else, use grid position
+        CurrentGridCoord = GridSystem->WorldToGrid(Hit.Location);
         bValidPlacement = !GridSystem->IsOccupied(CurrentGridCoord);
     }
     else
@@ -604,34 +648,29 @@ void AF12BuilderController::UpdateDeleteHighlight()
     if (!InstancedRenderer)
         return;
 
-    FHitResult Hit;
+    FF12GridCoord HitGridCoord;
+    int32 TileIndex;
     
-    if (TraceFromCamera(Hit))
+    if (PickModuleFromCamera(HitGridCoord, TileIndex))
     {
-        FF12GridCoord HitGridCoord;
-        int32 TileIndex;
+        // Shift = single tile, no shift = full module
+        bool bSingleTile = bModifierHeld;
         
-        if (InstancedRenderer->GetHitModuleAndTile(Hit, HitGridCoord, TileIndex))
+        // Check if highlight needs to change
+        bool bNeedsUpdate = !bHasHighlight ||
+                           !(HitGridCoord == LastHighlightCoord) ||
+                           (bSingleTile && LastHighlightTile != TileIndex) ||
+                           (bSingleTile != bLastHighlightWasSingleTile);
+        
+        if (bNeedsUpdate)
         {
-            // Shift = single tile, no shift = full module
-            bool bSingleTile = bModifierHeld;
-            
-            // Check if highlight needs to change
-            bool bNeedsUpdate = !bHasHighlight ||
-                               !(HitGridCoord == LastHighlightCoord) ||
-                               (bSingleTile && LastHighlightTile != TileIndex) ||
-                               (bSingleTile != bLastHighlightWasSingleTile);
-            
-            if (bNeedsUpdate)
-            {
-                InstancedRenderer->SetTileHighlight(HitGridCoord, TileIndex, true, bSingleTile);
-                LastHighlightCoord = HitGridCoord;
-                LastHighlightTile = TileIndex;
-                bLastHighlightWasSingleTile = bSingleTile;
-                bHasHighlight = true;
-            }
-            return;
+            InstancedRenderer->SetTileHighlight(HitGridCoord, TileIndex, true, bSingleTile);
+            LastHighlightCoord = HitGridCoord;
+            LastHighlightTile = TileIndex;
+            bLastHighlightWasSingleTile = bSingleTile;
+            bHasHighlight = true;
         }
+        return;
     }
     
     // No hit - clear highlight
@@ -721,10 +760,16 @@ void AF12BuilderController::UpdateDragPreview()
         return;
 
     // Get current mouse position in world
+    FF12GridCoord HitGridCoord;
+    int32 TileIndex;
     FHitResult Hit;
     FVector CurrentMouseWorld;
     
-    if (TraceFromCamera(Hit))
+    if (PickModuleFromCamera(HitGridCoord, TileIndex, &CurrentMouseWorld))
+    {
+        // Mouse is over a module
+    }
+    else if (TraceFromCamera(Hit))
     {
         CurrentMouseWorld = Hit.ImpactPoint;
     }
@@ -778,9 +823,10 @@ void AF12BuilderController::UpdateDragPreview()
     }
     
     // Show ghosts for each preview coord
-    for (int32 i = 0; i < DragPreviewCoords.Num(); i++)
+    GridSystem->GridToWorldBatch(DragPreviewCoords, DragPreviewPositions);
+    for (int32 i = 0; i < DragPreviewPositions.Num(); i++)
     {
-        ShowGhostAtCoord(DragPreviewCoords[i], i);
+        ShowGhostAtPosition(DragPreviewPositions[i], i);
     }
     
     // Hide remaining ghosts
@@ -798,14 +844,17 @@ void AF12BuilderController::ShowGhostAtCoord(FF12GridCoord Coord, int32 GhostSet
 {
     if (!GridSystem)
         return;
-    
+
+    // Get world position for this module coordinate
+    ShowGhostAtPosition(GridSystem->GridToWorld(Coord), GhostSetIndex);
+}
+
+void AF12BuilderController::ShowGhostAtPosition(const FVector& ModuleCenter, int32 GhostSetIndex)
+{
     int32 BaseIndex = GhostSetIndex * 12;
     if (BaseIndex + 11 >= GhostMeshComponents.Num())
         return;
 
-    // Get world position for this module coordinate
-    FVector ModuleCenter = GridSystem->GridToWorld(Coord);
-    
     // Position each ghost tile at its face location
     for (int32 i = 0; i < 12; i++)
     {
@@ -854,6 +903,8 @@ void AF12BuilderController::PlaceDraggedModules()
     if (!GridSystem || !InstancedRenderer || DragPreviewCoords.Num() == 0)
         return;
 
+    // Instances for the whole drag are created once when the batch closes
+    FF12ScopedEditBatch Batch(InstancedRenderer);
     for (const FF12GridCoord& Coord : DragPreviewCoords)
     {
         if (!GridSystem->IsOccupied(Coord))
@@ -883,26 +934,29 @@ void AF12BuilderController::RemoveModule()
     if (!GridSystem || !InstancedRenderer)
         return;
 
-    FHitResult Hit;
-    if (TraceFromCamera(Hit))
+    FF12GridCoord GridCoord;
+    int32 TileIndex;
+    
+    if (PickModuleFromCamera(GridCoord, TileIndex))
     {
-        FF12GridCoord GridCoord;
-        int32 TileIndex;
-        
-        if (InstancedRenderer->GetHitModuleAndTile(Hit, GridCoord, TileIndex))
+        // Can't delete core
+        if (GridCoord.X == 0 && GridCoord.Y == 0 && GridCoord.Z == 0)
         {
-            // Can't delete core
-            if (GridCoord.X == 0 && GridCoord.Y == 0 && GridCoord.Z == 0)
-            {
-                UE_LOG(LogTemp, Warning, TEXT("Cannot remove core module"));
-                return;
-            }
-            
-            InstancedRenderer->RemoveModule(GridCoord);
-            GridSystem->ClearOccupied(GridCoord);
-            
-            UE_LOG(LogTemp, Log, TEXT("Removed module at (%d, %d, %d)"), GridCoord.X, GridCoord.Y, GridCoord.Z);
+            UE_LOG(LogTemp, Warning, TEXT("Cannot remove core module"));
+            return;
         }
+
+        if (GridSystem->bPreventStationSplit && GridSystem->WouldRemovalSplit(GridCoord))
+        {
+            UE_LOG(LogTemp, Warning, TEXT("Cannot remove module at (%d, %d, %d): station would split"),
+                GridCoord.X, GridCoord.Y, GridCoord.Z);
+            return;
+        }
+        
+        InstancedRenderer->RemoveModule(GridCoord);
+        GridSystem->ClearOccupied(GridCoord);
+        
+        UE_LOG(LogTemp, Log, TEXT("Removed module at (%d, %d, %d)"), GridCoord.X, GridCoord.Y, GridCoord.Z);
     }
 }
 
@@ -926,26 +980,46 @@ void AF12BuilderController::GenerateModules(const TArray<FF12GridCoord>& Coords)
     if (!InstancedRenderer || !GridSystem || Coords.Num() == 0)
         return;
 
+    // Occupy in one pass; only positions that were empty come back
     TArray<FF12GridCoord> ValidCoords;
-    
-    for (const FF12GridCoord& Coord : Coords)
-    {
-        if (!GridSystem->IsOccupied(Coord))
-        {
-            ValidCoords.Add(Coord);
-            GridSystem->SetOccupied(Coord, nullptr);
-        }
-    }
+    GridSystem->SetOccupiedBulk(Coords, ValidCoords);
     
     InstancedRenderer->AddModulesBulk(ValidCoords, CurrentPaintMaterialIndex);
     
     UE_LOG(LogTemp, Log, TEXT("Generated %d modules"), ValidCoords.Num());
 }
 
+int32 AF12BuilderController::DeleteFloatingIslands()
+{
+    if (!InstancedRenderer || !GridSystem)
+        return 0;
+
+    if (!GridSystem->IsOccupied(FF12GridCoord(0, 0, 0)))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("DeleteFloatingIslands: No core module, nothing to anchor to"));
+        return 0;
+    }
+
+    TArray<FF12GridCoord> Floating = GridSystem->GetFloatingModules();
+    if (Floating.Num() == 0)
+        return 0;
+
+    InstancedRenderer->RemoveModulesBulk(Floating);
+    GridSystem->ClearOccupiedBulk(Floating);
+
+    UE_LOG(LogTemp, Log, TEXT("Deleted %d floating modules (%d islands left)"), Floating.Num(), GridSystem->GetIslandCount());
+    return Floating.Num();
+}
+
 // === HUD HELPERS ===
 
 FLinearColor AF12BuilderController::GetCurrentPaintColor() const
 {
+    if (bUseCustomPaintColor)
+    {
+        return CustomPaintColor;
+    }
+
     if (PaintColors.Num() > 0 && PaintColors.IsValidIndex(CurrentPaintMaterialIndex))
     {
         return PaintColors[CurrentPaintMaterialIndex];
@@ -65,6 +65,17 @@ public:
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Builder|Mode")
     int32 CurrentPaintMaterialIndex = 0;
 
+    // Paint with CustomPaintColor instead of the palette entry
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Builder|Paint")
+    bool bUseCustomPaintColor = false;
+
+    // Free paint colour set by the HUD picker
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Builder|Paint")
+    FLinearColor CustomPaintColor = FLinearColor::White;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Builder|Paint", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+    float CustomPaintRoughness = 0.5f;
+
     // === PREVIEW ===
     
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Builder")
@@ -115,6 +126,14 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Builder")
     void CyclePaintMaterial();
 
+    // Paint with a free colour from now on (switches away from the palette)
+    UFUNCTION(BlueprintCallable, Category = "Builder|Paint")
+    void SetCustomPaintColor(FLinearColor Color, float Roughness);
+
+    // Paint with the palette again
+    UFUNCTION(BlueprintCallable, Category = "Builder|Paint")
+    void UsePalettePaint();
+
     // === PROCEDURAL GENERATION ===
     
     UFUNCTION(BlueprintCallable, Category = "Builder|Generation")
@@ -127,6 +146,11 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Builder|Generation")
     void GenerateModules(const TArray<FF12GridCoord>& Coords);
 
+    // Delete every module that is no longer connected to the core
+    // Returns the number of modules removed
+    UFUNCTION(BlueprintCallable, Category = "Builder")
+    int32 DeleteFloatingIslands();
+
     // === HUD HELPERS ===
     
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Builder|HUD")
@@ -184,6 +208,7 @@ protected:
     FVector DragStartWorldPos;          // World position where drag started
     int32 DragFaceIndex;                // Which face was clicked
     TArray<FF12GridCoord> DragPreviewCoords;  // Coords being previewed
+    TArray<FVector> DragPreviewPositions;     // World centers of DragPreviewCoords
 
     // Ghost preview meshes for build mode (12 tiles per preview module)
     UPROPERTY()
@@ -199,6 +224,7 @@ protected:
     void UpdateGhostPreview();
     void UpdateDragPreview();
     void ShowGhostAtCoord(FF12GridCoord Coord, int32 GhostSetIndex = 0);
+    void ShowGhostAtPosition(const FVector& ModuleCenter, int32 GhostSetIndex = 0);
     void HideGhost();
     void HideAllGhosts();
     void PlaceDraggedModules();
@@ -212,6 +238,9 @@ protected:
     // Perform trace from camera
     bool TraceFromCamera(FHitResult& OutHit);
 
+    // Module and tile under the mouse, using the grid raycast instead of a physics trace
+    bool PickModuleFromCamera(FF12GridCoord& OutGridCoord, int32& OutTileIndex, FVector* OutHitLocation = nullptr);
+
     // Update ghost preview / cursor position
     void UpdatePreview();
 
@@ -223,6 +252,9 @@ protected:
     void HandleBuildSecondary();
     void HandlePaintPrimary();
     void HandlePaintSecondary();
+
+    // Paint a module (or one tile) with the current palette entry or free colour
+    void ApplyPaint(FF12GridCoord GridCoord, int32 TileIndex, bool bSingleTile);
     void HandleDeletePrimary();
     void HandleDeleteSecondary();
 
@@ -5,6 +5,7 @@
 #include "F12BuilderController.h"
 #include "Components/Border.h"
 #include "Components/TextBlock.h"
+#include "Components/Slider.h"
 #include "Kismet/GameplayStatics.h"
 
 void UF12BuilderHUD::NativeConstruct()
@@ -17,6 +18,18 @@ void UF12BuilderHUD::NativeConstruct()
         PaintButton ? TEXT("Found") : TEXT("NULL"),
         DeleteButton ? TEXT("Found") : TEXT("NULL"),
         ModeLabel ? TEXT("Found") : TEXT("NULL"));
+
+    // Colour picker
+    for (USlider* Slider : { PaintRedSlider, PaintGreenSlider, PaintBlueSlider, PaintRoughnessSlider })
+    {
+        if (Slider)
+        {
+            Slider->SetMinValue(0.0f);
+            Slider->SetMaxValue(1.0f);
+            Slider->OnValueChanged.AddDynamic(this, &UF12BuilderHUD::OnPaintSliderChanged);
+        }
+    }
+    SyncPaintSliders();
     
     // Initial update
     UpdateDisplay();
@@ -119,7 +132,9 @@ void UF12BuilderHUD::UpdateDisplay()
     {
         if (bIsPaint)
         {
-            FString IndexText = FString::Printf(TEXT("Material: %d"), Controller->CurrentPaintMaterialIndex + 1);
+            FString IndexText = Controller->bUseCustomPaintColor
+                ? FString::Printf(TEXT("Colour: #%s"), *Controller->CustomPaintColor.ToFColor(true).ToHex().Left(6))
+                : FString::Printf(TEXT("Material: %d"), Controller->CurrentPaintMaterialIndex + 1);
             PaintIndexLabel->SetText(FText::FromString(IndexText));
             PaintIndexLabel->SetVisibility(ESlateVisibility::Visible);
         }
@@ -128,4 +143,43 @@ void UF12BuilderHUD::UpdateDisplay()
             PaintIndexLabel->SetVisibility(ESlateVisibility::Hidden);
         }
     }
+
+    // === UPDATE COLOUR PICKER ===
+    const ESlateVisibility PickerVisibility = bIsPaint ? ESlateVisibility::Visible : ESlateVisibility::Collapsed;
+    for (USlider* Slider : { PaintRedSlider, PaintGreenSlider, PaintBlueSlider, PaintRoughnessSlider })
+    {
+        if (Slider)
+        {
+            Slider->SetVisibility(PickerVisibility);
+        }
+    }
+}
+
+void UF12BuilderHUD::OnPaintSliderChanged(float Value)
+{
+    AF12BuilderController* Controller = GetBuilderController();
+    if (!Controller)
+        return;
+
+    // Sliders that are not bound keep the controller's current value
+    FLinearColor Color = Controller->CustomPaintColor;
+    float Roughness = Controller->CustomPaintRoughness;
+    if (PaintRedSlider)       Color.R = PaintRedSlider->GetValue();
+    if (PaintGreenSlider)     Color.G = PaintGreenSlider->GetValue();
+    if (PaintBlueSlider)      Color.B = PaintBlueSlider->GetValue();
+    if (PaintRoughnessSlider) Roughness = PaintRoughnessSlider->GetValue();
+
+    Controller->SetCustomPaintColor(Color, Roughness);
+}
+
+void UF12BuilderHUD::SyncPaintSliders()
+{
+    AF12BuilderController* Controller = GetBuilderController();
+    if (!Controller)
+        return;
+
+    if (PaintRedSlider)       PaintRedSlider->SetValue(Controller->CustomPaintColor.R);
+    if (PaintGreenSlider)     PaintGreenSlider->SetValue(Controller->CustomPaintColor.G);
+    if (PaintBlueSlider)      PaintBlueSlider->SetValue(Controller->CustomPaintColor.B);
+    if (PaintRoughnessSlider) PaintRoughnessSlider->SetValue(Controller->CustomPaintRoughness);
 }
\ No newline at end of file
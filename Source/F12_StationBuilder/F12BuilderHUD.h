@@ -14,6 +14,7 @@
 class AF12BuilderController;
 class UBorder;
 class UTextBlock;
+class USlider;
 
 UCLASS()
 class UF12BuilderHUD : public UUserWidget
@@ -47,6 +48,20 @@ protected:
     UPROPERTY(meta = (BindWidgetOptional))
     UTextBlock* PaintIndexLabel;
 
+    // Free paint colour picker (optional, shown in paint mode; range 0-1)
+    // Moving any slider switches the controller from PaintColors to the picked colour
+    UPROPERTY(meta = (BindWidgetOptional))
+    USlider* PaintRedSlider;
+
+    UPROPERTY(meta = (BindWidgetOptional))
+    USlider* PaintGreenSlider;
+
+    UPROPERTY(meta = (BindWidgetOptional))
+    USlider* PaintBlueSlider;
+
+    UPROPERTY(meta = (BindWidgetOptional))
+    USlider* PaintRoughnessSlider;
+
     // =====================================================================
     // COLORS - Customize these in the Blueprint defaults
     // =====================================================================
@@ -72,4 +87,11 @@ protected:
 
     // Update all displays
     void UpdateDisplay();
+
+    // Any colour picker slider moved
+    UFUNCTION()
+    void OnPaintSliderChanged(float Value);
+
+    // Copy the controller's free colour into the sliders
+    void SyncPaintSliders();
 };
\ No newline at end of file
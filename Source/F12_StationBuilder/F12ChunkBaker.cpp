@@ -0,0 +1,118 @@
+// F12ChunkBaker.cpp
+// Implementation of the chunk mesh baker
+
+#include "F12ChunkBaker.h"
+
+FVector F12ChunkBaker::GetChunkOrigin(const FF12ChunkBakeParams& Params)
+{
+    const FIntVector FirstCell(Params.ChunkCoord.X << Params.ChunkShift, Params.ChunkCoord.Y << Params.ChunkShift, Params.ChunkCoord.Z << Params.ChunkShift);
+    return FVector(FirstCell) * Params.Spacing;
+}
+
+void F12ChunkBaker::BakeChunk(const FF12StationSnapshot& Snapshot, const FF12ChunkBakeParams& Params, FF12BakedChunkMesh& OutMesh)
+{
+    OutMesh.Sections.Reset();
+    OutMesh.NumFaces = 0;
+
+    // Face corners relative to the module center, wound so the front side faces out
+    // (procedural mesh front faces have (P2 - P0) x (P1 - P0) along the normal)
+    FVector Corners[F12Lattice::NumFaces][4];
+    int32 TriangleOrder[F12Lattice::NumFaces][6];
+    for (int32 Face = 0; Face < F12Lattice::NumFaces; Face++)
+    {
+        for (int32 Corner = 0; Corner < 4; Corner++)
+        {
+            Corners[Face][Corner] = F12Lattice::GetVertex(F12Lattice::FaceVertices[Face][Corner], Params.ModuleSize);
+        }
+
+        const FVector FrontNormal = FVector::CrossProduct(Corners[Face][2] - Corners[Face][0], Corners[Face][1] - Corners[Face][0]);
+        const bool bFlip = FVector::DotProduct(FrontNormal, F12Lattice::GetFaceNormal(Face)) < 0.0;
+        const int32 Order[6] = { 0, 1, 2, 0, 2, 3 };
+        const int32 Flipped[6] = { 0, 2, 1, 0, 3, 2 };
+        FMemory::Memcpy(TriangleOrder[Face], bFlip ? Flipped : Order, sizeof(Order));
+    }
+
+    static const FVector2D CornerUVs[4] = { FVector2D(0.0, 0.5), FVector2D(0.5, 0.0), FVector2D(1.0, 0.5), FVector2D(0.5, 1.0) };
+
+    const int32 NumMaterials = FMath::Max(Params.NumMaterials, 1);
+    TArray<int32> SectionOfMaterial;
+    SectionOfMaterial.Init(INDEX_NONE, NumMaterials);
+
+    // The chunk's cells, and the snapshot bricks covering them
+    const int32 ChunkCells = 1 << Params.ChunkShift;
+    const FIntVector MinCell(Params.ChunkCoord.X << Params.ChunkShift, Params.ChunkCoord.Y << Params.ChunkShift, Params.ChunkCoord.Z << Params.ChunkShift);
+    const FIntVector MaxCell = MinCell + FIntVector(ChunkCells - 1);
+    const FIntVector MinBrick = FF12OccupancyStore::GetBrickCoord(MinCell);
+    const FIntVector MaxBrick = FF12OccupancyStore::GetBrickCoord(MaxCell);
+
+    for (int32 BZ = MinBrick.Z; BZ <= MaxBrick.Z; BZ++)
+    {
+        for (int32 BY = MinBrick.Y; BY <= MaxBrick.Y; BY++)
+        {
+            for (int32 BX = MinBrick.X; BX <= MaxBrick.X; BX++)
+            {
+                const FF12SnapshotChunk* Brick = Snapshot.FindChunk(FIntVector(BX, BY, BZ));
+                if (!Brick)
+                    continue;
+
+                // Modules are stored in the order ForEachCellInBrick visits the cells
+                int32 ModuleIdx = 0;
+                FF12OccupancyStore::ForEachCellInBrick(Brick->Cells, [&](const FIntVector& Cell)
+                {
+                    const FF12SnapshotModule& Module = Brick->Modules[ModuleIdx++];
+                    if (Cell.X < MinCell.X || Cell.Y < MinCell.Y || Cell.Z < MinCell.Z
+                        || Cell.X > MaxCell.X || Cell.Y > MaxCell.Y || Cell.Z > MaxCell.Z)
+                    {
+                        return;
+                    }
+
+                    const FVector ModulePos = FVector(Cell - MinCell) * Params.Spacing;
+                    for (int32 Face = 0; Face < F12Lattice::NumFaces; Face++)
+                    {
+                        if (!(Module.VisibleTiles & (1 << Face)))
+                            continue;
+                        if (Params.bCullInteriorFaces && Snapshot.IsOccupied(F12Lattice::GetNeighbor(Cell, Face)))
+                            continue;
+
+                        const int32 MatIdx = FMath::Clamp((int32)Module.TileMaterials[Face], 0, NumMaterials - 1);
+                        const int32 SectionMat = Params.bPackPaint ? 0 : MatIdx;
+                        if (SectionOfMaterial[SectionMat] == INDEX_NONE)
+                        {
+                            SectionOfMaterial[SectionMat] = OutMesh.Sections.Num();
+                            OutMesh.Sections.AddDefaulted_GetRef().MaterialIndex = SectionMat;
+                        }
+                        FF12BakedSection& Section = OutMesh.Sections[SectionOfMaterial[SectionMat]];
+
+                        // Same values as the tile's custom data: [0] in U, [4] in V, [1..3] in the colour
+                        FVector2D PaintUV((float)MatIdx, -1.0f);
+                        FColor Color = FColor::Black;
+                        if (Params.bPackPaint && (Module.ColoredTiles & (1 << Face)))
+                        {
+                            PaintUV.Y = F12TilePaint::UnpackRoughness(Module.TileColors[Face]);
+                            Color = F12TilePaint::UnpackColor(Module.TileColors[Face]).ToFColor(true);
+                        }
+                        const FVector Normal = F12Lattice::GetFaceNormal(Face);
+
+                        const int32 FirstVertex = Section.Vertices.Num();
+                        for (int32 Corner = 0; Corner < 4; Corner++)
+                        {
+                            Section.Vertices.Add(ModulePos + Corners[Face][Corner]);
+                            Section.Normals.Add(Normal);
+                            Section.UVs.Add(CornerUVs[Corner]);
+                            if (Params.bPackPaint)
+                            {
+                                Section.PaintUVs.Add(PaintUV);
+                                Section.Colors.Add(Color);
+                            }
+                        }
+                        for (int32 Index = 0; Index < 6; Index++)
+                        {
+                            Section.Triangles.Add(FirstVertex + TriangleOrder[Face][Index]);
+                        }
+                        OutMesh.NumFaces++;
+                    }
+                });
+            }
+        }
+    }
+}
@@ -0,0 +1,67 @@
+// F12ChunkBaker.h
+// Bakes the visible faces of one render chunk into a merged mesh (one section per material, or one with packed paint)
+// Reads only a station snapshot, so bakes can run on worker threads
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "F12StationSnapshot.h"
+
+// Geometry of one material's faces, in the layout UProceduralMeshComponent::CreateMeshSection takes
+struct FF12BakedSection
+{
+    int32 MaterialIndex = 0;
+
+    TArray<FVector> Vertices;
+    TArray<int32> Triangles;
+    TArray<FVector> Normals;
+    TArray<FVector2D> UVs;
+
+    // Packed paint only (see FF12ChunkBakeParams::bPackPaint), empty otherwise:
+    // UV1 = (palette index, free colour roughness or -1), vertex colour = free colour
+    TArray<FVector2D> PaintUVs;
+    TArray<FColor> Colors;
+};
+
+struct FF12BakedChunkMesh
+{
+    TArray<FF12BakedSection> Sections;
+
+    // Faces baked (4 vertices, 2 triangles each)
+    int32 NumFaces = 0;
+};
+
+// Everything a bake needs besides the snapshot (copied into the worker)
+struct FF12ChunkBakeParams
+{
+    // Render chunk coordinate (cell >> ChunkShift)
+    FIntVector ChunkCoord = FIntVector::ZeroValue;
+    int32 ChunkShift = 4;
+
+    // World distance between lattice points along one axis
+    double Spacing = 0.0;
+
+    // Module size the faces are built for (see F12Lattice::GetVertex)
+    float ModuleSize = 600.0f;
+
+    // Drop faces shared with an occupied cell
+    bool bCullInteriorFaces = true;
+
+    // Material indices are clamped to [0, NumMaterials)
+    int32 NumMaterials = 1;
+
+    // CustomData mode: bake every face into one section and carry each tile's paint in UV1 and the
+    // vertex colour (the layout TileMasterMaterial reads from custom data). Otherwise there is one
+    // section per palette material and free colours are dropped, as on per-material instances.
+    bool bPackPaint = false;
+};
+
+namespace F12ChunkBaker
+{
+    // World position of the chunk's first cell; baked vertices are relative to it
+    FVector GetChunkOrigin(const FF12ChunkBakeParams& Params);
+
+    // Build one flat rhombus per visible face of every module in the chunk.
+    // Thread-safe: reads nothing but its arguments.
+    void BakeChunk(const FF12StationSnapshot& Snapshot, const FF12ChunkBakeParams& Params, FF12BakedChunkMesh& OutMesh);
+}
@@ -0,0 +1,470 @@
+// F12Connectivity.cpp
+// Implementation of the incremental island index
+
+#include "F12Connectivity.h"
+
+// === EDITS ===
+
+void FF12ConnectivityIndex::OnCellAdded(const FIntVector& Cell, const FF12OccupancyStore& Occupancy)
+{
+    const uint64 Key = F12LatticeKey::Encode(Cell);
+    if (CellLabels.Contains(Key))
+        return;
+
+    // New single-cell island, then merge with every occupied neighbor
+    const int32 Label = NewLabel(1);
+    CellLabels.Add(Key, Label);
+    NumIslands++;
+
+    uint16 Mask = Occupancy.GetNeighborMask(Cell);
+    while (Mask)
+    {
+        const int32 Face = (int32)FMath::CountTrailingZeros((uint32)Mask);
+        Mask &= Mask - 1;
+
+        const int32 NeighborRoot = GetRoot(F12Lattice::GetNeighbor(Cell, Face));
+        if (NeighborRoot != INDEX_NONE && Union(Label, NeighborRoot))
+        {
+            NumIslands--;
+        }
+    }
+}
+
+void FF12ConnectivityIndex::OnCellsAdded(TConstArrayView<FIntVector> Cells, const FF12OccupancyStore& Occupancy)
+{
+    CellLabels.Reserve(CellLabels.Num() + Cells.Num());
+
+    // Neighbors that are not labeled yet are joined when their own turn comes
+    for (const FIntVector& Cell : Cells)
+    {
+        OnCellAdded(Cell, Occupancy);
+    }
+
+    CompactIfNeeded(Occupancy);
+}
+
+void FF12ConnectivityIndex::OnCellRemoved(const FIntVector& Cell, uint16 NeighborMask, const FF12OccupancyStore& Occupancy)
+{
+    int32 Label;
+    if (!CellLabels.RemoveAndCopyValue(F12LatticeKey::Encode(Cell), Label))
+        return;
+
+    const int32 Root = FindRoot(Label);
+    if (--Sizes[Root] == 0)
+    {
+        NumIslands--;
+        return;
+    }
+
+    // With one neighbor left the island cannot have split
+    if (FMath::CountBits(NeighborMask) <= 1)
+    {
+        CompactIfNeeded(Occupancy);
+        return;
+    }
+
+    TArray<FIntVector> Starts;
+    while (NeighborMask)
+    {
+        const int32 Face = (int32)FMath::CountTrailingZeros((uint32)NeighborMask);
+        NeighborMask &= NeighborMask - 1;
+        Starts.Add(F12Lattice::GetNeighbor(Cell, Face));
+    }
+
+    FFloodResult Result;
+    Flood(Starts, nullptr, false, Occupancy, Result);
+    SplitOffPieces(Result);
+
+    CompactIfNeeded(Occupancy);
+}
+
+void FF12ConnectivityIndex::OnCellsRemoved(TConstArrayView<FIntVector> Cells, const FF12OccupancyStore& Occupancy)
+{
+    for (const FIntVector& Cell : Cells)
+    {
+        int32 Label;
+        if (CellLabels.RemoveAndCopyValue(F12LatticeKey::Encode(Cell), Label))
+        {
+            const int32 Root = FindRoot(Label);
+            if (--Sizes[Root] == 0)
+            {
+                NumIslands--;
+            }
+        }
+    }
+
+    // Every piece that may have been cut off touches the removed region,
+    // so flood from the occupied cells along its boundary
+    TArray<FIntVector> Starts;
+    TF12FlatMap<uint8> StartKeys;
+    for (const FIntVector& Cell : Cells)
+    {
+        for (int32 Face = 0; Face < F12Lattice::NumFaces; Face++)
+        {
+            const FIntVector Neighbor = F12Lattice::GetNeighbor(Cell, Face);
+            const uint64 NeighborKey = F12LatticeKey::Encode(Neighbor);
+            if (CellLabels.Contains(NeighborKey) && !StartKeys.Contains(NeighborKey))
+            {
+                StartKeys.Add(NeighborKey, 1);
+                Starts.Add(Neighbor);
+            }
+        }
+    }
+
+    if (Starts.Num() > 1)
+    {
+        FFloodResult Result;
+        Flood(Starts, nullptr, false, Occupancy, Result);
+        SplitOffPieces(Result);
+    }
+
+    CompactIfNeeded(Occupancy);
+}
+
+void FF12ConnectivityIndex::Rebuild(const FF12OccupancyStore& Occupancy)
+{
+    Reset();
+    CellLabels.Reserve(Occupancy.Num());
+
+    TArray<FIntVector> Stack;
+    Occupancy.ForEachOccupied([this, &Stack, &Occupancy](const FIntVector& Seed)
+    {
+        const uint64 SeedKey = F12LatticeKey::Encode(Seed);
+        if (CellLabels.Contains(SeedKey))
+            return;
+
+        // Label the whole island of this seed
+        const int32 Label = NewLabel(0);
+        NumIslands++;
+        CellLabels.Add(SeedKey, Label);
+        Stack.Add(Seed);
+
+        while (Stack.Num() > 0)
+        {
+            const FIntVector Cell = Stack.Pop(EAllowShrinking::No);
+            Sizes[Label]++;
+
+            uint16 Mask = Occupancy.GetNeighborMask(Cell);
+            while (Mask)
+            {
+                const int32 Face = (int32)FMath::CountTrailingZeros((uint32)Mask);
+                Mask &= Mask - 1;
+
+                const FIntVector Neighbor = F12Lattice::GetNeighbor(Cell, Face);
+                const uint64 NeighborKey = F12LatticeKey::Encode(Neighbor);
+                if (!CellLabels.Contains(NeighborKey))
+                {
+                    CellLabels.Add(NeighborKey, Label);
+                    Stack.Add(Neighbor);
+                }
+            }
+        }
+    });
+}
+
+void FF12ConnectivityIndex::Reset()
+{
+    CellLabels.Empty();
+    Parent.Empty();
+    Sizes.Empty();
+    NumIslands = 0;
+}
+
+// === QUERIES ===
+
+int32 FF12ConnectivityIndex::GetIslandSize(const FIntVector& Cell) const
+{
+    const int32 Root = GetRoot(Cell);
+    return Root != INDEX_NONE ? Sizes[Root] : 0;
+}
+
+bool FF12ConnectivityIndex::IsConnected(const FIntVector& A, const FIntVector& B) const
+{
+    const int32 RootA = GetRoot(A);
+    return RootA != INDEX_NONE && RootA == GetRoot(B);
+}
+
+bool FF12ConnectivityIndex::WouldRemovalSplit(const FIntVector& Cell, const FF12OccupancyStore& Occupancy) const
+{
+    uint16 Mask = Occupancy.GetNeighborMask(Cell);
+    if (FMath::CountBits(Mask) <= 1)
+        return false;
+
+    TArray<FIntVector> Starts;
+    while (Mask)
+    {
+        const int32 Face = (int32)FMath::CountTrailingZeros((uint32)Mask);
+        Mask &= Mask - 1;
+        Starts.Add(F12Lattice::GetNeighbor(Cell, Face));
+    }
+
+    FFloodResult Result;
+    Flood(Starts, &Cell, true, Occupancy, Result);
+    return Result.bSplit;
+}
+
+void FF12ConnectivityIndex::GetCellsNotConnectedToAnchor(TArray<FIntVector>& OutCells) const
+{
+    const int32 AnchorRoot = GetRoot(AnchorCell);
+    if (AnchorRoot == INDEX_NONE)
+        return;
+
+    OutCells.Reserve(OutCells.Num() + CellLabels.Num() - Sizes[AnchorRoot]);
+    CellLabels.ForEach([this, AnchorRoot, &OutCells](uint64 Key, int32 Label)
+    {
+        if (FindRoot(Label) != AnchorRoot)
+        {
+            OutCells.Add(F12LatticeKey::Decode(Key));
+        }
+    });
+}
+
+SIZE_T FF12ConnectivityIndex::GetAllocatedSize() const
+{
+    return CellLabels.GetAllocatedSize() + Parent.GetAllocatedSize() + Sizes.GetAllocatedSize();
+}
+
+// === FLOOD ===
+
+void FF12ConnectivityIndex::Flood(const TArray<FIntVector>& Starts, const FIntVector* ExcludedCell, bool bStopAtFirstSplit,
+    const FF12OccupancyStore& Occupancy, FFloodResult& OutResult) const
+{
+    const int32 NumFloods = Starts.Num();
+
+    // Per flood: BFS queue (doubles as the list of cells it owns) and read position
+    TArray<TArray<FIntVector>> Queues;
+    Queues.SetNum(NumFloods);
+    TArray<int32> Heads;
+    Heads.SetNumZeroed(NumFloods);
+
+    // Floods that meet are merged into groups (union-find over flood indices).
+    // OpenFloods counts, per group root, the floods that still have cells to expand.
+    TArray<int32> GroupParent;
+    TArray<int32> OpenFloods;
+    GroupParent.SetNumUninitialized(NumFloods);
+    OpenFloods.Init(1, NumFloods);
+
+    auto FindGroup = [&GroupParent](int32 Flood)
+    {
+        while (GroupParent[Flood] != Flood)
+        {
+            GroupParent[Flood] = GroupParent[GroupParent[Flood]];
+            Flood = GroupParent[Flood];
+        }
+        return Flood;
+    };
+
+    // Cell key -> owning flood
+    TF12FlatMap<int32> Owner;
+    Owner.Reserve(NumFloods * 16);
+
+    // Floods still expanding, advanced one cell each per round
+    TArray<int32> Active;
+    Active.Reserve(NumFloods);
+
+    for (int32 FloodIdx = 0; FloodIdx < NumFloods; FloodIdx++)
+    {
+        checkSlow(!Owner.Contains(F12LatticeKey::Encode(Starts[FloodIdx])));
+        GroupParent[FloodIdx] = FloodIdx;
+        Owner.Add(F12LatticeKey::Encode(Starts[FloodIdx]), FloodIdx);
+        Queues[FloodIdx].Add(Starts[FloodIdx]);
+        Active.Add(FloodIdx);
+    }
+
+    int32 NumGroups = NumFloods;
+    int32 NumOpenGroups = NumFloods;
+    TArray<int32> ClosedGroups;
+
+    while (NumOpenGroups > 1)
+    {
+        for (int32 ActiveIdx = 0; ActiveIdx < Active.Num() && NumOpenGroups > 1; )
+        {
+            const int32 FloodIdx = Active[ActiveIdx];
+            const FIntVector Cell = Queues[FloodIdx][Heads[FloodIdx]++];
+
+            uint16 Mask = Occupancy.GetNeighborMask(Cell);
+            while (Mask)
+            {
+                const int32 Face = (int32)FMath::CountTrailingZeros((uint32)Mask);
+                Mask &= Mask - 1;
+
+                const FIntVector Neighbor = F12Lattice::GetNeighbor(Cell, Face);
+                if (ExcludedCell && Neighbor == *ExcludedCell)
+                    continue;
+
+                const uint64 NeighborKey = F12LatticeKey::Encode(Neighbor);
+                if (const int32* OtherFlood = Owner.Find(NeighborKey))
+                {
+                    const int32 GroupA = FindGroup(FloodIdx);
+                    const int32 GroupB = FindGroup(*OtherFlood);
+                    if (GroupA != GroupB)
+                    {
+                        // Two floods met: both sides are one piece
+                        GroupParent[GroupB] = GroupA;
+                        OpenFloods[GroupA] += OpenFloods[GroupB];
+                        NumGroups--;
+                        NumOpenGroups--;
+                    }
+                }
+                else
+                {
+                    Owner.Add(NeighborKey, FloodIdx);
+                    Queues[FloodIdx].Add(Neighbor);
+                }
+            }
+
+            if (Heads[FloodIdx] < Queues[FloodIdx].Num())
+            {
+                ActiveIdx++;
+                continue;
+            }
+
+            // This flood ran dry. Once a whole group has, that group is a complete piece
+            // (anything touching it would have been claimed or merged on the way).
+            Active.RemoveAtSwap(ActiveIdx, 1, EAllowShrinking::No);
+            const int32 Group = FindGroup(FloodIdx);
+            if (--OpenFloods[Group] == 0)
+            {
+                NumOpenGroups--;
+                ClosedGroups.Add(Group);
+
+                if (bStopAtFirstSplit && NumGroups > 1)
+                {
+                    OutResult.bSplit = true;
+                    return;
+                }
+            }
+        }
+    }
+
+    OutResult.bSplit = NumGroups > 1;
+    if (!OutResult.bSplit || bStopAtFirstSplit)
+        return;
+
+    // At most one group is still open; it is the rest of the island
+    if (Active.Num() > 0)
+    {
+        OutResult.bHasOpenGroup = true;
+        OutResult.OpenCell = Starts[Active[0]];
+    }
+
+    // Gather the cells of each closed group
+    TMap<int32, int32> GroupToPiece;
+    for (int32 Group : ClosedGroups)
+    {
+        GroupToPiece.Add(Group, OutResult.ClosedPieces.AddDefaulted());
+    }
+
+    for (int32 FloodIdx = 0; FloodIdx < NumFloods; FloodIdx++)
+    {
+        if (const int32* PieceIdx = GroupToPiece.Find(FindGroup(FloodIdx)))
+        {
+            OutResult.ClosedPieces[*PieceIdx].Append(Queues[FloodIdx]);
+        }
+    }
+}
+
+void FF12ConnectivityIndex::SplitOffPieces(FFloodResult& Result)
+{
+    if (!Result.bSplit)
+        return;
+
+    // Old island of every piece (looked up before anything is relabeled)
+    const int32 NumPieces = Result.ClosedPieces.Num();
+    TArray<int32> PieceRoots;
+    PieceRoots.SetNumUninitialized(NumPieces);
+    for (int32 PieceIdx = 0; PieceIdx < NumPieces; PieceIdx++)
+    {
+        PieceRoots[PieceIdx] = GetRoot(Result.ClosedPieces[PieceIdx][0]);
+    }
+
+    // One piece per old island keeps the old label: the open group if it belongs
+    // to that island, otherwise the largest closed piece (fewest cells to relabel)
+    const int32 OpenRoot = Result.bHasOpenGroup ? GetRoot(Result.OpenCell) : INDEX_NONE;
+    TMap<int32, int32> KeeperByRoot;
+    for (int32 PieceIdx = 0; PieceIdx < NumPieces; PieceIdx++)
+    {
+        const int32 Root = PieceRoots[PieceIdx];
+        if (Root == OpenRoot)
+            continue;
+
+        int32& Keeper = KeeperByRoot.FindOrAdd(Root, PieceIdx);
+        if (Result.ClosedPieces[PieceIdx].Num() > Result.ClosedPieces[Keeper].Num())
+        {
+            Keeper = PieceIdx;
+        }
+    }
+
+    for (int32 PieceIdx = 0; PieceIdx < NumPieces; PieceIdx++)
+    {
+        const int32 Root = PieceRoots[PieceIdx];
+        const int32* Keeper = KeeperByRoot.Find(Root);
+        if (Keeper && *Keeper == PieceIdx)
+            continue;
+
+        const TArray<FIntVector>& Piece = Result.ClosedPieces[PieceIdx];
+        const int32 Label = NewLabel(Piece.Num());
+        Sizes[Root] -= Piece.Num();
+        NumIslands++;
+
+        for (const FIntVector& Cell : Piece)
+        {
+            CellLabels.Add(F12LatticeKey::Encode(Cell), Label);
+        }
+    }
+}
+
+// === UNION-FIND ===
+
+int32 FF12ConnectivityIndex::NewLabel(int32 Size)
+{
+    const int32 Label = Parent.Add(Parent.Num());
+    Sizes.Add(Size);
+    return Label;
+}
+
+int32 FF12ConnectivityIndex::FindRoot(int32 Label) const
+{
+    // Path halving
+    while (Parent[Label] != Label)
+    {
+        Parent[Label] = Parent[Parent[Label]];
+        Label = Parent[Label];
+    }
+    return Label;
+}
+
+bool FF12ConnectivityIndex::Union(int32 LabelA, int32 LabelB)
+{
+    int32 RootA = FindRoot(LabelA);
+    int32 RootB = FindRoot(LabelB);
+    if (RootA == RootB)
+        return false;
+
+    // Union by size
+    if (Sizes[RootA] < Sizes[RootB])
+    {
+        Swap(RootA, RootB);
+    }
+    Parent[RootB] = RootA;
+    Sizes[RootA] += Sizes[RootB];
+    return true;
+}
+
+int32 FF12ConnectivityIndex::GetRoot(const FIntVector& Cell) const
+{
+    if (!F12LatticeKey::IsInRange(Cell))
+        return INDEX_NONE;
+
+    const int32* Label = CellLabels.Find(F12LatticeKey::Encode(Cell));
+    return Label ? FindRoot(*Label) : INDEX_NONE;
+}
+
+void FF12ConnectivityIndex::CompactIfNeeded(const FF12OccupancyStore& Occupancy)
+{
+    // Labels are never reused; a full relabel every ~N edits keeps the forest small (amortized O(1))
+    if (Parent.Num() > CellLabels.Num() * 2 + 1024)
+    {
+        Rebuild(Occupancy);
+    }
+}
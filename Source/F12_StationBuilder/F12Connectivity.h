@@ -0,0 +1,112 @@
+// F12Connectivity.h
+// Incremental island tracking for the module graph (modules are linked across shared faces)
+// Inserts merge labels with union-find; deletes run bounded local floods from the removed cells' neighbors
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "F12FlatMap.h"
+#include "F12OccupancyStore.h"
+
+/**
+ * Connected-component index over the occupied cells of an FF12OccupancyStore.
+ *
+ * Every tracked cell carries a label; labels are joined with union-find, so the
+ * island of a cell is the root of its label. Adding a cell unions it with its
+ * occupied neighbors. Removing a cell starts one flood per remaining neighbor and
+ * advances them in lockstep: floods that meet are merged, and the search stops as
+ * soon as at most one merged flood is still open. Closed floods are islands that
+ * got cut off and receive fresh labels, so the cost is bounded by the size of the
+ * smaller pieces rather than the whole station.
+ *
+ * The owner must call the On* functions after every change to the occupancy store.
+ */
+class FF12ConnectivityIndex
+{
+public:
+    // Cell that anchors the station (the core module)
+    FIntVector AnchorCell = FIntVector::ZeroValue;
+
+    // Cell was just set in Occupancy (its neighbor mask must be current)
+    void OnCellAdded(const FIntVector& Cell, const FF12OccupancyStore& Occupancy);
+
+    // Cells were just set in Occupancy (e.g. after SetBulk)
+    void OnCellsAdded(TConstArrayView<FIntVector> Cells, const FF12OccupancyStore& Occupancy);
+
+    // Cell was just cleared in Occupancy; NeighborMask is its mask from before the clear
+    void OnCellRemoved(const FIntVector& Cell, uint16 NeighborMask, const FF12OccupancyStore& Occupancy);
+
+    // Cells were just cleared in Occupancy
+    void OnCellsRemoved(TConstArrayView<FIntVector> Cells, const FF12OccupancyStore& Occupancy);
+
+    // Relabel everything from scratch
+    void Rebuild(const FF12OccupancyStore& Occupancy);
+
+    void Reset();
+
+    // Number of separate islands (a station with no floating parts has 1)
+    int32 GetIslandCount() const { return NumIslands; }
+
+    // Number of cells in the island containing Cell (0 if not tracked)
+    int32 GetIslandSize(const FIntVector& Cell) const;
+
+    bool IsConnected(const FIntVector& A, const FIntVector& B) const;
+
+    bool IsConnectedToAnchor(const FIntVector& Cell) const { return IsConnected(Cell, AnchorCell); }
+
+    // Would removing this (occupied) cell cut the remaining cells into more than one piece?
+    // Same bounded search as OnCellRemoved, without modifying anything.
+    bool WouldRemovalSplit(const FIntVector& Cell, const FF12OccupancyStore& Occupancy) const;
+
+    // Append every tracked cell that is not connected to the anchor.
+    // Appends nothing if the anchor itself is empty (there is no reference island).
+    void GetCellsNotConnectedToAnchor(TArray<FIntVector>& OutCells) const;
+
+    SIZE_T GetAllocatedSize() const;
+
+private:
+    // Result of a lockstep flood from several start cells
+    struct FFloodResult
+    {
+        // Cells of every flood group that closed (was fully explored without meeting another group)
+        TArray<TArray<FIntVector>> ClosedPieces;
+
+        // Any cell of the group that was still open when the search stopped (valid if bHasOpenGroup)
+        FIntVector OpenCell = FIntVector::ZeroValue;
+        bool bHasOpenGroup = false;
+
+        // True if the starts ended up in more than one group
+        bool bSplit = false;
+    };
+
+    // Flood from Starts over occupied cells, never entering ExcludedCell.
+    // With bStopAtFirstSplit the search ends as soon as a split is certain (pieces are not collected).
+    void Flood(const TArray<FIntVector>& Starts, const FIntVector* ExcludedCell, bool bStopAtFirstSplit,
+        const FF12OccupancyStore& Occupancy, FFloodResult& OutResult) const;
+
+    // Give closed pieces their own labels after a flood
+    void SplitOffPieces(FFloodResult& Result);
+
+    int32 NewLabel(int32 Size);
+    int32 FindRoot(int32 Label) const;
+
+    // Returns true if two different islands were merged
+    bool Union(int32 LabelA, int32 LabelB);
+
+    // Root label of the island containing Cell, or INDEX_NONE if not tracked
+    int32 GetRoot(const FIntVector& Cell) const;
+
+    // Start over when dead labels outnumber live cells
+    void CompactIfNeeded(const FF12OccupancyStore& Occupancy);
+
+    // Lattice key of the cell -> label
+    TF12FlatMap<int32> CellLabels;
+
+    // Union-find forest over labels (path halving mutates it during const lookups)
+    mutable TArray<int32> Parent;
+
+    // Cell count per root label
+    TArray<int32> Sizes;
+
+    int32 NumIslands = 0;
+};
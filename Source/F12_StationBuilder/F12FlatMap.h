@@ -0,0 +1,421 @@
+// F12FlatMap.h
+// Flat open-addressing hash map keyed by packed 64-bit keys (see F12LatticeKey.h)
+// Linear probing with backward-shift deletion: no tombstones, no per-node allocations
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "F12LatticeKey.h"
+#include <new>
+#include <type_traits>
+
+/**
+ * Hash map from uint64 to ValueType stored in two flat arrays (keys and values).
+ * F12LatticeKey::InvalidKey marks empty slots and must never be inserted.
+ *
+ * Pointers and references into the map are invalidated by any insert or remove.
+ */
+template <typename ValueType>
+class TF12FlatMap
+{
+public:
+    static constexpr uint64 EmptyKey = F12LatticeKey::InvalidKey;
+
+    TF12FlatMap() = default;
+
+    TF12FlatMap(const TF12FlatMap& Other)
+    {
+        *this = Other;
+    }
+
+    TF12FlatMap(TF12FlatMap&& Other)
+    {
+        *this = MoveTemp(Other);
+    }
+
+    ~TF12FlatMap()
+    {
+        DestroyAll();
+    }
+
+    TF12FlatMap& operator=(const TF12FlatMap& Other)
+    {
+        if (this != &Other)
+        {
+            DestroyAll();
+            Keys = Other.Keys;
+            Values.SetNumUninitialized(Other.Values.Num());
+            for (int32 Slot = 0; Slot < Keys.Num(); Slot++)
+            {
+                if (Keys[Slot] != EmptyKey)
+                {
+                    new (GetValuePtr(Slot)) ValueType(*Other.GetValuePtr(Slot));
+                }
+            }
+            Count = Other.Count;
+        }
+        return *this;
+    }
+
+    TF12FlatMap& operator=(TF12FlatMap&& Other)
+    {
+        if (this != &Other)
+        {
+            DestroyAll();
+            Keys = MoveTemp(Other.Keys);
+            Values = MoveTemp(Other.Values);
+            Count = Other.Count;
+            Other.Count = 0;
+        }
+        return *this;
+    }
+
+    int32 Num() const { return Count; }
+
+    bool Contains(uint64 Key) const
+    {
+        return FindSlot(Key) != INDEX_NONE;
+    }
+
+    ValueType* Find(uint64 Key)
+    {
+        const int32 Slot = FindSlot(Key);
+        return Slot != INDEX_NONE ? GetValuePtr(Slot) : nullptr;
+    }
+
+    const ValueType* Find(uint64 Key) const
+    {
+        const int32 Slot = FindSlot(Key);
+        return Slot != INDEX_NONE ? GetValuePtr(Slot) : nullptr;
+    }
+
+    // Insert or overwrite
+    ValueType& Add(uint64 Key, const ValueType& Value)
+    {
+        bool bExisted;
+        const int32 Slot = FindOrInsertSlot(Key, bExisted);
+        if (bExisted)
+        {
+            *GetValuePtr(Slot) = Value;
+        }
+        else
+        {
+            new (GetValuePtr(Slot)) ValueType(Value);
+        }
+        return *GetValuePtr(Slot);
+    }
+
+    ValueType& Add(uint64 Key, ValueType&& Value)
+    {
+        bool bExisted;
+        const int32 Slot = FindOrInsertSlot(Key, bExisted);
+        if (bExisted)
+        {
+            *GetValuePtr(Slot) = MoveTemp(Value);
+        }
+        else
+        {
+            new (GetValuePtr(Slot)) ValueType(MoveTemp(Value));
+        }
+        return *GetValuePtr(Slot);
+    }
+
+    // Find the value, default-constructing it if missing
+    ValueType& FindOrAdd(uint64 Key)
+    {
+        bool bExisted;
+        const int32 Slot = FindOrInsertSlot(Key, bExisted);
+        if (!bExisted)
+        {
+            new (GetValuePtr(Slot)) ValueType();
+        }
+        return *GetValuePtr(Slot);
+    }
+
+    // Returns true if the key was present
+    bool Remove(uint64 Key)
+    {
+        const int32 Slot = FindSlot(Key);
+        if (Slot == INDEX_NONE)
+            return false;
+
+        RemoveAtSlot(Slot);
+        return true;
+    }
+
+    bool RemoveAndCopyValue(uint64 Key, ValueType& OutValue)
+    {
+        const int32 Slot = FindSlot(Key);
+        if (Slot == INDEX_NONE)
+            return false;
+
+        OutValue = MoveTemp(*GetValuePtr(Slot));
+        RemoveAtSlot(Slot);
+        return true;
+    }
+
+    // Remove everything and free the table
+    void Empty()
+    {
+        DestroyAll();
+        Keys.Empty();
+        Values.Empty();
+    }
+
+    // Remove everything but keep the table allocated
+    void Reset()
+    {
+        DestroyAll();
+        for (uint64& Key : Keys)
+        {
+            Key = EmptyKey;
+        }
+    }
+
+    // Make room for at least NumElements without rehashing
+    void Reserve(int32 NumElements)
+    {
+        const int32 Needed = GetCapacityFor(NumElements);
+        if (Needed > Keys.Num())
+        {
+            Rehash(Needed);
+        }
+    }
+
+    SIZE_T GetAllocatedSize() const
+    {
+        return Keys.GetAllocatedSize() + Values.GetAllocatedSize();
+    }
+
+    // Visit every element in table order: Func(uint64 Key, ValueType& Value)
+    template <typename FuncType>
+    void ForEach(FuncType&& Func)
+    {
+        for (int32 Slot = 0; Slot < Keys.Num(); Slot++)
+        {
+            if (Keys[Slot] != EmptyKey)
+            {
+                Func(Keys[Slot], *GetValuePtr(Slot));
+            }
+        }
+    }
+
+    template <typename FuncType>
+    void ForEach(FuncType&& Func) const
+    {
+        for (int32 Slot = 0; Slot < Keys.Num(); Slot++)
+        {
+            if (Keys[Slot] != EmptyKey)
+            {
+                Func(Keys[Slot], *GetValuePtr(Slot));
+            }
+        }
+    }
+
+    // Append all keys; with lattice keys, sorted order is Morton (Z-curve) order
+    void GetKeys(TArray<uint64>& OutKeys, bool bSorted = false) const
+    {
+        OutKeys.Reserve(OutKeys.Num() + Count);
+        for (uint64 Key : Keys)
+        {
+            if (Key != EmptyKey)
+            {
+                OutKeys.Add(Key);
+            }
+        }
+        if (bSorted)
+        {
+            OutKeys.Sort();
+        }
+    }
+
+    // Visit every element in ascending key order (spatially coherent for lattice keys).
+    // Func must not add or remove elements.
+    template <typename FuncType>
+    void ForEachSorted(FuncType&& Func) const
+    {
+        TArray<uint64> SortedKeys;
+        GetKeys(SortedKeys, true);
+        for (uint64 Key : SortedKeys)
+        {
+            Func(Key, *GetValuePtr(FindSlot(Key)));
+        }
+    }
+
+    // Range-for support; Pair.Key / Pair.Value like TMap
+    template <bool bConst>
+    struct TPairRef
+    {
+        uint64 Key;
+        std::conditional_t<bConst, const ValueType&, ValueType&> Value;
+    };
+
+    template <bool bConst>
+    class TIteratorBase
+    {
+    public:
+        using MapType = std::conditional_t<bConst, const TF12FlatMap, TF12FlatMap>;
+
+        TIteratorBase(MapType& InMap, int32 InSlot) : Map(InMap), Slot(InSlot) { SkipEmpty(); }
+
+        TPairRef<bConst> operator*() const { return { Map.Keys[Slot], *Map.GetValuePtr(Slot) }; }
+        TIteratorBase& operator++() { Slot++; SkipEmpty(); return *this; }
+        bool operator!=(const TIteratorBase& Other) const { return Slot != Other.Slot; }
+
+    private:
+        void SkipEmpty()
+        {
+            while (Slot < Map.Keys.Num() && Map.Keys[Slot] == EmptyKey)
+            {
+                Slot++;
+            }
+        }
+
+        MapType& Map;
+        int32 Slot;
+    };
+
+    TIteratorBase<false> begin() { return TIteratorBase<false>(*this, 0); }
+    TIteratorBase<false> end() { return TIteratorBase<false>(*this, Keys.Num()); }
+    TIteratorBase<true> begin() const { return TIteratorBase<true>(*this, 0); }
+    TIteratorBase<true> end() const { return TIteratorBase<true>(*this, Keys.Num()); }
+
+private:
+    // Keep load factor at or below 1/2 so linear probe runs stay short
+    static constexpr int32 MinCapacity = 16;
+
+    static int32 GetCapacityFor(int32 NumElements)
+    {
+        return (int32)FMath::RoundUpToPowerOfTwo((uint32)FMath::Max(MinCapacity, NumElements * 2));
+    }
+
+    // Fibonacci hashing spreads the clustered low bits of Morton keys across the table
+    FORCEINLINE int32 GetHomeSlot(uint64 Key) const
+    {
+        return (int32)((Key * 0x9E3779B97F4A7C15ull) >> 32) & (Keys.Num() - 1);
+    }
+
+    FORCEINLINE ValueType* GetValuePtr(int32 Slot)
+    {
+        return Values[Slot].GetTypedPtr();
+    }
+
+    FORCEINLINE const ValueType* GetValuePtr(int32 Slot) const
+    {
+        return Values[Slot].GetTypedPtr();
+    }
+
+    int32 FindSlot(uint64 Key) const
+    {
+        if (Count == 0)
+            return INDEX_NONE;
+
+        const int32 Mask = Keys.Num() - 1;
+        for (int32 Slot = GetHomeSlot(Key); ; Slot = (Slot + 1) & Mask)
+        {
+            const uint64 SlotKey = Keys[Slot];
+            if (SlotKey == Key)
+                return Slot;
+            if (SlotKey == EmptyKey)
+                return INDEX_NONE;
+        }
+    }
+
+    // Returns the slot for Key; if it was not present the key is written and the value is left unconstructed
+    int32 FindOrInsertSlot(uint64 Key, bool& bOutExisted)
+    {
+        checkSlow(Key != EmptyKey);
+
+        if ((Count + 1) * 2 > Keys.Num())
+        {
+            Rehash(GetCapacityFor(Count + 1));
+        }
+
+        const int32 Mask = Keys.Num() - 1;
+        for (int32 Slot = GetHomeSlot(Key); ; Slot = (Slot + 1) & Mask)
+        {
+            const uint64 SlotKey = Keys[Slot];
+            if (SlotKey == Key)
+            {
+                bOutExisted = true;
+                return Slot;
+            }
+            if (SlotKey == EmptyKey)
+            {
+                Keys[Slot] = Key;
+                Count++;
+                bOutExisted = false;
+                return Slot;
+            }
+        }
+    }
+
+    // Backward-shift deletion: pull later entries of the probe run into the hole
+    void RemoveAtSlot(int32 Slot)
+    {
+        const int32 Mask = Keys.Num() - 1;
+        GetValuePtr(Slot)->~ValueType();
+
+        int32 Hole = Slot;
+        for (int32 Next = (Hole + 1) & Mask; Keys[Next] != EmptyKey; Next = (Next + 1) & Mask)
+        {
+            // An entry may move into the hole only if its home slot is not between the hole and its position
+            const int32 Home = GetHomeSlot(Keys[Next]);
+            const bool bCanMove = ((Next - Home) & Mask) >= ((Next - Hole) & Mask);
+            if (bCanMove)
+            {
+                Keys[Hole] = Keys[Next];
+                new (GetValuePtr(Hole)) ValueType(MoveTemp(*GetValuePtr(Next)));
+                GetValuePtr(Next)->~ValueType();
+                Hole = Next;
+            }
+        }
+
+        Keys[Hole] = EmptyKey;
+        Count--;
+    }
+
+    void Rehash(int32 NewCapacity)
+    {
+        TArray<uint64> OldKeys = MoveTemp(Keys);
+        TArray<TTypeCompatibleBytes<ValueType>> OldValues = MoveTemp(Values);
+
+        Keys.Init(EmptyKey, NewCapacity);
+        Values.SetNumUninitialized(NewCapacity);
+
+        const int32 Mask = NewCapacity - 1;
+        for (int32 OldSlot = 0; OldSlot < OldKeys.Num(); OldSlot++)
+        {
+            const uint64 Key = OldKeys[OldSlot];
+            if (Key == EmptyKey)
+                continue;
+
+            int32 Slot = GetHomeSlot(Key);
+            while (Keys[Slot] != EmptyKey)
+            {
+                Slot = (Slot + 1) & Mask;
+            }
+
+            ValueType* OldValue = OldValues[OldSlot].GetTypedPtr();
+            Keys[Slot] = Key;
+            new (GetValuePtr(Slot)) ValueType(MoveTemp(*OldValue));
+            OldValue->~ValueType();
+        }
+    }
+
+    void DestroyAll()
+    {
+        for (int32 Slot = 0; Slot < Keys.Num(); Slot++)
+        {
+            if (Keys[Slot] != EmptyKey)
+            {
+                GetValuePtr(Slot)->~ValueType();
+            }
+        }
+        Count = 0;
+    }
+
+    TArray<uint64> Keys;
+    TArray<TTypeCompatibleBytes<ValueType>> Values;
+    int32 Count = 0;
+};
@@ -10,57 +10,28 @@ AF12GridSystem::AF12GridSystem()
 
 TArray<FIntVector> AF12GridSystem::GetNeighborOffsets()
 {
-    // Offsets matching the face normals in GetFaceNormals()
-    // Each offset points in the direction of the corresponding face
-    
+    // Blueprint copy of the constexpr table; C++ callers should use F12Lattice directly
     TArray<FIntVector> Offsets;
+    Offsets.Reserve(F12Lattice::NumFaces);
     
-    // Faces 0-3: around +X octahedral
-    Offsets.Add(FIntVector( 1,  0, -1));  // Face 0: +X, -Z
-    Offsets.Add(FIntVector( 1, -1,  0));  // Face 1: +X, -Y
-    Offsets.Add(FIntVector( 1,  0,  1));  // Face 2: +X, +Z
-    Offsets.Add(FIntVector( 1,  1,  0));  // Face 3: +X, +Y
-    
-    // Faces 4-7: around -X octahedral
-    Offsets.Add(FIntVector(-1,  0, -1));  // Face 4: -X, -Z
-    Offsets.Add(FIntVector(-1,  1,  0));  // Face 5: -X, +Y
-    Offsets.Add(FIntVector(-1,  0,  1));  // Face 6: -X, +Z
-    Offsets.Add(FIntVector(-1, -1,  0));  // Face 7: -X, -Y
-    
-    // Faces 8-11: connecting Y and Z axes
-    Offsets.Add(FIntVector( 0,  1,  1));  // Face 8: +Y, +Z
-    Offsets.Add(FIntVector( 0,  1, -1));  // Face 9: +Y, -Z
-    Offsets.Add(FIntVector( 0, -1,  1));  // Face 10: -Y, +Z
-    Offsets.Add(FIntVector( 0, -1, -1));  // Face 11: -Y, -Z
+    for (int32 Face = 0; Face < F12Lattice::NumFaces; Face++)
+    {
+        Offsets.Add(F12Lattice::GetNeighborOffset(Face));
+    }
     
     return Offsets;
 }
 
 TArray<FVector> AF12GridSystem::GetFaceNormals()
 {
-    // Face normals matching F12Module's FRhombicDodecahedron
-    // These are computed from the face vertex positions
-    static const float S = 0.707107f;  // sqrt(2)/2
-    
+    // Blueprint copy of the constexpr table; C++ callers should use F12Lattice directly
     TArray<FVector> Normals;
+    Normals.Reserve(F12Lattice::NumFaces);
     
-    // Faces 0-3: around +X octahedral
-    Normals.Add(FVector( S,  0, -S));   // Face 0: +X, -Z
-    Normals.Add(FVector( S, -S,  0));   // Face 1: +X, -Y
-    Normals.Add(FVector( S,  0,  S));   // Face 2: +X, +Z
-    Normals.Add(FVector( S,  S,  0));   // Face 3: +X, +Y
-    
-    // Faces 4-7: around -X octahedral
-    Normals.Add(FVector(-S,  0, -S));   // Face 4: -X, -Z
-    Normals.Add(FVector(-S,  S,  0));   // Face 5: -X, +Y
-    Normals.Add(FVector(-S,  0,  S));   // Face 6: -X, +Z
-    Normals.Add(FVector(-S, -S,  0));   // Face 7: -X, -Y
-    
-    // Faces 8-11: connecting Y and Z axes
-    Normals.Add(FVector( 0,  S,  S));   // Face 8: +Y, +Z
-    Normals.Add(FVector( 0,  S, -S));   // Face 9: +Y, -Z
-    Normals.Add(FVector( 0, -S,  S));   // Face 10: -Y, +Z
-    Normals.Add(FVector( 0, -S, -S));   // Face 11: -Y, -Z
+    for (int32 Face = 0; Face < F12Lattice::NumFaces; Face++)
+    {
+        Normals.Add(F12Lattice::GetFaceNormal(Face));
+    }
     
     return Normals;
 }
@@ -68,30 +39,22 @@ TArray<FVector> AF12GridSystem::GetFaceNormals()
 FF12GridCoord AF12GridSystem::WorldToGrid(FVector WorldPosition)
 {
     // Convert world position to grid coordinates
-    // The grid spacing must account for tile thickness to prevent overlap
-    // 
-    // Geometry:
-    // - Face center is at distance R = ModuleSize/2 from module center
-    // - Tiles have thickness T, extending T/2 outward
-    // - For tiles to just touch (not overlap): center-to-center = 2*(R + T/2)
-    // - Base spacing factor is sqrt(2)/2 ≈ 0.707 for BCC lattice
-    // - Adjusted factor = 0.707 * (ModuleSize + TileThickness) / ModuleSize
-    
-    float AdjustedSpacing = ModuleSize * 0.707f * (ModuleSize + TileThickness) / ModuleSize;
-    
-    FF12GridCoord Coord;
-    Coord.X = FMath::RoundToInt(WorldPosition.X / AdjustedSpacing);
-    Coord.Y = FMath::RoundToInt(WorldPosition.Y / AdjustedSpacing);
-    Coord.Z = FMath::RoundToInt(WorldPosition.Z / AdjustedSpacing);
+    // The grid spacing must account for tile thickness to prevent overlap (see F12Lattice::GetAdjustedSpacing)
+    // Rounding each axis on its own can land on an odd-parity cell, so snap to the closest lattice point
+    const double InvSpacing = 1.0 / GetAdjustedSpacing();
     
-    return Coord;
+    return FF12GridCoord(F12Lattice::NearestLatticePoint(
+        WorldPosition.X * InvSpacing,
+        WorldPosition.Y * InvSpacing,
+        WorldPosition.Z * InvSpacing
+    ));
 }
 
 FVector AF12GridSystem::GridToWorld(FF12GridCoord GridCoord)
 {
     // Convert grid coordinates to world position
     // Use adjusted spacing to prevent tile overlap
-    float AdjustedSpacing = ModuleSize * 0.707f * (ModuleSize + TileThickness) / ModuleSize;
+    float AdjustedSpacing = GetAdjustedSpacing();
     
     return FVector(
         GridCoord.X * AdjustedSpacing,
@@ -100,39 +63,383 @@ FVector AF12GridSystem::GridToWorld(FF12GridCoord GridCoord)
     );
 }
 
+void AF12GridSystem::WorldToGridBatch(const TArray<FVector>& WorldPositions, TArray<FF12GridCoord>& OutCoords) const
+{
+    const int32 Num = WorldPositions.Num();
+    OutCoords.SetNumUninitialized(Num);
+
+    const double InvSpacing = 1.0 / GetAdjustedSpacing();
+    const FVector* In = WorldPositions.GetData();
+    FF12GridCoord* Out = OutCoords.GetData();
+
+    const VectorRegister4Double VInvSpacing = VectorSetFloat1(InvSpacing);
+    const VectorRegister4Double VZero = VectorSetFloat1(0.0);
+    const VectorRegister4Double VHalf = VectorSetFloat1(0.5);
+    const VectorRegister4Double VOne = VectorSetFloat1(1.0);
+    const VectorRegister4Double VNegOne = VectorSetFloat1(-1.0);
+    const VectorRegister4Double VTwo = VectorSetFloat1(2.0);
+
+    // Four points per iteration, one register per axis.
+    // Same decoder as F12Lattice::NearestLatticePoint, with the branches turned into masks.
+    int32 Index = 0;
+    for (; Index + 4 <= Num; Index += 4)
+    {
+        const FVector* P = In + Index;
+        const VectorRegister4Double X = VectorMultiply(MakeVectorRegisterDouble(P[0].X, P[1].X, P[2].X, P[3].X), VInvSpacing);
+        const VectorRegister4Double Y = VectorMultiply(MakeVectorRegisterDouble(P[0].Y, P[1].Y, P[2].Y, P[3].Y), VInvSpacing);
+        const VectorRegister4Double Z = VectorMultiply(MakeVectorRegisterDouble(P[0].Z, P[1].Z, P[2].Z, P[3].Z), VInvSpacing);
+
+        VectorRegister4Double RX = VectorFloor(VectorAdd(X, VHalf));
+        VectorRegister4Double RY = VectorFloor(VectorAdd(Y, VHalf));
+        VectorRegister4Double RZ = VectorFloor(VectorAdd(Z, VHalf));
+
+        const VectorRegister4Double DX = VectorSubtract(X, RX);
+        const VectorRegister4Double DY = VectorSubtract(Y, RY);
+        const VectorRegister4Double DZ = VectorSubtract(Z, RZ);
+
+        // Sum - 2 * floor(Sum / 2) is 0 for even and 1 for odd parity
+        const VectorRegister4Double Sum = VectorAdd(VectorAdd(RX, RY), RZ);
+        const VectorRegister4Double Parity = VectorSubtract(Sum, VectorMultiply(VectorFloor(VectorMultiply(Sum, VHalf)), VTwo));
+        const VectorRegister4Double OddMask = VectorCompareGT(Parity, VHalf);
+
+        // Pick the axis with the largest rounding error
+        const VectorRegister4Double AX = VectorAbs(DX);
+        const VectorRegister4Double AY = VectorAbs(DY);
+        const VectorRegister4Double AZ = VectorAbs(DZ);
+        const VectorRegister4Double MaskX = VectorBitwiseAnd(VectorCompareGE(AX, AY), VectorCompareGE(AX, AZ));
+        const VectorRegister4Double MaskY = VectorSelect(MaskX, VZero, VectorCompareGE(AY, AZ));
+        const VectorRegister4Double MaskZ = VectorSelect(VectorBitwiseOr(MaskX, MaskY), VZero, OddMask);
+
+        // Step that axis one unit towards the original position
+        const VectorRegister4Double StepX = VectorSelect(VectorCompareGE(DX, VZero), VOne, VNegOne);
+        const VectorRegister4Double StepY = VectorSelect(VectorCompareGE(DY, VZero), VOne, VNegOne);
+        const VectorRegister4Double StepZ = VectorSelect(VectorCompareGE(DZ, VZero), VOne, VNegOne);
+
+        RX = VectorAdd(RX, VectorBitwiseAnd(VectorBitwiseAnd(OddMask, MaskX), StepX));
+        RY = VectorAdd(RY, VectorBitwiseAnd(VectorBitwiseAnd(OddMask, MaskY), StepY));
+        RZ = VectorAdd(RZ, VectorBitwiseAnd(MaskZ, StepZ));
+
+        double CX[4], CY[4], CZ[4];
+        VectorStore(RX, CX);
+        VectorStore(RY, CY);
+        VectorStore(RZ, CZ);
+
+        for (int32 Lane = 0; Lane < 4; Lane++)
+        {
+            Out[Index + Lane] = FF12GridCoord((int32)CX[Lane], (int32)CY[Lane], (int32)CZ[Lane]);
+        }
+    }
+
+    // Remainder
+    for (; Index < Num; Index++)
+    {
+        Out[Index] = FF12GridCoord(F12Lattice::NearestLatticePoint(In[Index].X * InvSpacing, In[Index].Y * InvSpacing, In[Index].Z * InvSpacing));
+    }
+}
+
+void AF12GridSystem::GridToWorldBatch(const TArray<FF12GridCoord>& GridCoords, TArray<FVector>& OutPositions) const
+{
+    const int32 Num = GridCoords.Num();
+    OutPositions.SetNumUninitialized(Num);
+
+    // Coordinates and positions are both packed XYZ triples, so they can be walked as flat arrays
+    static_assert(sizeof(FF12GridCoord) == 3 * sizeof(int32), "FF12GridCoord must be three packed int32");
+    static_assert(sizeof(FVector) == 3 * sizeof(double), "FVector must be three packed doubles");
+
+    if (Num == 0)
+        return;
+
+    const double Spacing = GetAdjustedSpacing();
+    const VectorRegister4Double VSpacing = VectorSetFloat1(Spacing);
+    const int32* In = &GridCoords.GetData()->X;
+    double* Out = &OutPositions.GetData()->X;
+
+    // Four points (twelve components) per iteration, three full registers
+    int32 Index = 0;
+    for (; Index + 4 <= Num; Index += 4)
+    {
+        const int32* C = In + Index * 3;
+        double* P = Out + Index * 3;
+        VectorStore(VectorMultiply(MakeVectorRegisterDouble((double)C[0], (double)C[1], (double)C[2], (double)C[3]), VSpacing), P);
+        VectorStore(VectorMultiply(MakeVectorRegisterDouble((double)C[4], (double)C[5], (double)C[6], (double)C[7]), VSpacing), P + 4);
+        VectorStore(VectorMultiply(MakeVectorRegisterDouble((double)C[8], (double)C[9], (double)C[10], (double)C[11]), VSpacing), P + 8);
+    }
+
+    // Remainder
+    for (; Index < Num; Index++)
+    {
+        const FF12GridCoord& Coord = GridCoords[Index];
+        OutPositions[Index] = FVector(Coord.X * Spacing, Coord.Y * Spacing, Coord.Z * Spacing);
+    }
+}
+
 bool AF12GridSystem::IsOccupied(FF12GridCoord GridCoord)
 {
-    return OccupiedPositions.Contains(GridCoord);
+    return Occupancy.IsOccupied(GridCoord.ToIntVector());
 }
 
 void AF12GridSystem::SetOccupied(FF12GridCoord GridCoord, AActor* Module)
 {
-    OccupiedPositions.Add(GridCoord, Module);
+    const FIntVector Cell = GridCoord.ToIntVector();
+    if (!F12LatticeKey::IsStorableCell(Cell))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("SetOccupied: (%d,%d,%d) is outside the lattice key range"), Cell.X, Cell.Y, Cell.Z);
+        return;
+    }
+    if (!FF12OccupancyStore::IsLatticeCell(Cell))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("SetOccupied: (%d,%d,%d) has odd parity and is not a lattice point"), Cell.X, Cell.Y, Cell.Z);
+        return;
+    }
+
+    if (Occupancy.Set(Cell))
+    {
+        Connectivity.OnCellAdded(Cell, Occupancy);
+    }
+
+    if (Module)
+    {
+        ModuleActors.Add(GridCoord, Module);
+    }
+    else if (ModuleActors.Num() > 0)
+    {
+        ModuleActors.Remove(GridCoord);
+    }
 }
 
 void AF12GridSystem::ClearOccupied(FF12GridCoord GridCoord)
 {
-    OccupiedPositions.Remove(GridCoord);
+    const FIntVector Cell = GridCoord.ToIntVector();
+    const uint16 NeighborMask = Occupancy.GetNeighborMask(Cell);
+    if (Occupancy.Clear(Cell))
+    {
+        Connectivity.OnCellRemoved(Cell, NeighborMask, Occupancy);
+    }
+
+    if (ModuleActors.Num() > 0)
+    {
+        ModuleActors.Remove(GridCoord);
+    }
+}
+
+int32 AF12GridSystem::SetOccupiedBulk(const TArray<FF12GridCoord>& GridCoords, TArray<FF12GridCoord>& OutAdded)
+{
+    TArray<FIntVector> Cells;
+    Cells.Reserve(GridCoords.Num());
+    int32 NumRejected = 0;
+    for (const FF12GridCoord& Coord : GridCoords)
+    {
+        if (F12LatticeKey::IsStorableCell(Coord.ToIntVector()) && FF12OccupancyStore::IsLatticeCell(Coord.ToIntVector()))
+        {
+            Cells.Add(Coord.ToIntVector());
+        }
+        else
+        {
+            NumRejected++;
+        }
+    }
+    if (NumRejected > 0)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("SetOccupiedBulk: %d cells outside the lattice key range or with odd parity were skipped"), NumRejected);
+    }
+
+    TArray<FIntVector> AddedCells;
+    AddedCells.Reserve(Cells.Num());
+    const int32 NumAdded = Occupancy.SetBulk(Cells, &AddedCells);
+    Connectivity.OnCellsAdded(AddedCells, Occupancy);
+
+    OutAdded.Reserve(OutAdded.Num() + NumAdded);
+    for (const FIntVector& Cell : AddedCells)
+    {
+        OutAdded.Add(FF12GridCoord(Cell));
+    }
+
+    return NumAdded;
+}
+
+int32 AF12GridSystem::GetNeighborMask(FF12GridCoord GridCoord) const
+{
+    return Occupancy.GetNeighborMask(GridCoord.ToIntVector());
+}
+
+void AF12GridSystem::RebuildNeighborMasks()
+{
+    Occupancy.RebuildNeighborMasks();
+}
+
+int32 AF12GridSystem::ClearOccupiedBulk(const TArray<FF12GridCoord>& GridCoords)
+{
+    TArray<FIntVector> RemovedCells;
+    RemovedCells.Reserve(GridCoords.Num());
+
+    for (const FF12GridCoord& Coord : GridCoords)
+    {
+        if (Occupancy.Clear(Coord.ToIntVector()))
+        {
+            RemovedCells.Add(Coord.ToIntVector());
+        }
+
+        if (ModuleActors.Num() > 0)
+        {
+            ModuleActors.Remove(Coord);
+        }
+    }
+
+    // One boundary search for the whole region instead of one per cell
+    Connectivity.OnCellsRemoved(RemovedCells, Occupancy);
+    return RemovedCells.Num();
+}
+
+bool AF12GridSystem::IsConnectedToCore(FF12GridCoord GridCoord) const
+{
+    return Connectivity.IsConnectedToAnchor(GridCoord.ToIntVector());
+}
+
+bool AF12GridSystem::WouldRemovalSplit(FF12GridCoord GridCoord) const
+{
+    const FIntVector Cell = GridCoord.ToIntVector();
+    return Occupancy.IsOccupied(Cell) && Connectivity.WouldRemovalSplit(Cell, Occupancy);
+}
+
+TArray<FF12GridCoord> AF12GridSystem::GetFloatingModules() const
+{
+    TArray<FIntVector> Cells;
+    Connectivity.GetCellsNotConnectedToAnchor(Cells);
+
+    TArray<FF12GridCoord> Coords;
+    Coords.Reserve(Cells.Num());
+    for (const FIntVector& Cell : Cells)
+    {
+        Coords.Add(FF12GridCoord(Cell));
+    }
+    return Coords;
+}
+
+// === REGION QUERIES ===
+
+void AF12GridSystem::QueryBox(FF12GridCoord MinCoord, FF12GridCoord MaxCoord, TArray<FF12GridCoord>& OutCoords) const
+{
+    OutCoords.Reset();
+
+    TArray<FIntVector> Cells;
+    Occupancy.QueryBox(MinCoord.ToIntVector(), MaxCoord.ToIntVector(), Cells);
+
+    OutCoords.Reserve(Cells.Num());
+    for (const FIntVector& Cell : Cells)
+    {
+        OutCoords.Add(FF12GridCoord(Cell));
+    }
+}
+
+bool AF12GridSystem::IsRegionEmpty(FF12GridCoord MinCoord, FF12GridCoord MaxCoord) const
+{
+    return !Occupancy.AnyOccupiedInBox(MinCoord.ToIntVector(), MaxCoord.ToIntVector());
+}
+
+void AF12GridSystem::QuerySphere(FVector Center, float Radius, TArray<FF12GridCoord>& OutCoords) const
+{
+    OutCoords.Reset();
+    if (Radius < 0.0f)
+        return;
+
+    // Compare module centers in grid units
+    const double InvSpacing = 1.0 / GetAdjustedSpacing();
+    const FVector C = Center * InvSpacing;
+    const double R = Radius * InvSpacing;
+    const double RadiusSq = R * R;
+    const double Span = FF12OccupancyBrick::LocalMask;
+
+    Occupancy.ForEachOccupiedCulled(
+        [&](const FF12OccupancyBrick& Brick)
+        {
+            // Box spanned by the brick's cell centers
+            const FIntVector Origin = Brick.GetOrigin();
+            const FVector Lo(Origin.X, Origin.Y, Origin.Z);
+            const FVector Hi = Lo + FVector(Span);
+
+            double NearSq = 0.0;
+            double FarSq = 0.0;
+            for (int32 Axis = 0; Axis < 3; Axis++)
+            {
+                const double Below = Lo[Axis] - C[Axis];
+                const double Above = C[Axis] - Hi[Axis];
+                const double Near = FMath::Max3(Below, Above, 0.0);
+                const double Far = FMath::Max(FMath::Abs(Below), FMath::Abs(Above));
+                NearSq += Near * Near;
+                FarSq += Far * Far;
+            }
+
+            if (NearSq > RadiusSq)
+                return EF12BrickOverlap::Outside;
+            return FarSq <= RadiusSq ? EF12BrickOverlap::Inside : EF12BrickOverlap::Partial;
+        },
+        [&](const FIntVector& Cell)
+        {
+            return FVector::DistSquared(FVector(Cell.X, Cell.Y, Cell.Z), C) <= RadiusSq;
+        },
+        [&OutCoords](const FIntVector& Cell)
+        {
+            OutCoords.Add(FF12GridCoord(Cell));
+        });
+}
+
+void AF12GridSystem::QueryFrustum(const FConvexVolume& Frustum, TArray<FF12GridCoord>& OutCoords) const
+{
+    OutCoords.Reset();
+
+    const float Spacing = GetAdjustedSpacing();
+
+    // Circumradius of a module: the octahedral vertices sit at ModuleSize / sqrt(2)
+    const float ModuleRadius = ModuleSize * F12Lattice::InvSqrt2;
+    const float HalfBrick = 0.5f * FF12OccupancyBrick::LocalMask * Spacing;
+    const FVector BrickExtent(HalfBrick + ModuleRadius);
+
+    Occupancy.ForEachOccupiedCulled(
+        [&](const FF12OccupancyBrick& Brick)
+        {
+            const FIntVector Origin = Brick.GetOrigin();
+            const FVector BrickCenter = FVector(Origin.X, Origin.Y, Origin.Z) * Spacing + FVector(HalfBrick);
+
+            bool bFullyContained = false;
+            if (!Frustum.IntersectBox(BrickCenter, BrickExtent, bFullyContained))
+                return EF12BrickOverlap::Outside;
+            return bFullyContained ? EF12BrickOverlap::Inside : EF12BrickOverlap::Partial;
+        },
+        [&](const FIntVector& Cell)
+        {
+            return Frustum.IntersectSphere(FVector(Cell.X, Cell.Y, Cell.Z) * Spacing, ModuleRadius);
+        },
+        [&OutCoords](const FIntVector& Cell)
+        {
+            OutCoords.Add(FF12GridCoord(Cell));
+        });
 }
 
 AActor* AF12GridSystem::GetModuleAt(FF12GridCoord GridCoord)
 {
-    AActor** Found = OccupiedPositions.Find(GridCoord);
+    AActor** Found = ModuleActors.Find(GridCoord);
     return Found ? *Found : nullptr;
 }
 
+TArray<FF12GridCoord> AF12GridSystem::GetOccupiedCells() const
+{
+    TArray<FF12GridCoord> Cells;
+    Cells.Reserve(Occupancy.Num());
+    Occupancy.ForEachOccupied([&Cells](const FIntVector& Cell)
+    {
+        Cells.Add(FF12GridCoord(Cell));
+    });
+    return Cells;
+}
+
 TArray<FF12GridCoord> AF12GridSystem::GetNeighborCoords(FF12GridCoord GridCoord)
 {
     TArray<FF12GridCoord> Neighbors;
-    TArray<FIntVector> Offsets = GetNeighborOffsets();
+    Neighbors.Reserve(F12Lattice::NumFaces);
     
-    for (const FIntVector& Offset : Offsets)
+    for (int32 Face = 0; Face < F12Lattice::NumFaces; Face++)
     {
-        Neighbors.Add(FF12GridCoord(
-            GridCoord.X + Offset.X,
-            GridCoord.Y + Offset.Y,
-            GridCoord.Z + Offset.Z
-        ));
+        Neighbors.Add(FF12GridCoord(F12Lattice::GetNeighbor(GridCoord.ToIntVector(), Face)));
     }
     
     return Neighbors;
@@ -141,40 +448,147 @@ TArray<FF12GridCoord> AF12GridSystem::GetNeighborCoords(FF12GridCoord GridCoord)
 int32 AF12GridSystem::GetHitFaceIndex(FF12GridCoord ModuleCoord, FVector HitLocation)
 {
     // Determine which face was hit based on the direction from module center to hit point
+    // (the face whose normal is most aligned with the hit direction)
     FVector ModuleCenter = GridToWorld(ModuleCoord);
-    FVector HitDirection = (HitLocation - ModuleCenter).GetSafeNormal();
-    
-    TArray<FVector> Normals = GetFaceNormals();
-    
-    // Find the face whose normal is most aligned with the hit direction
-    int32 BestFace = -1;
-    float BestDot = -2.0f;
-    
-    for (int32 i = 0; i < 12; i++)
+    return F12Lattice::GetFaceForDirection(HitLocation - ModuleCenter);
+}
+
+bool AF12GridSystem::RaycastModules(FVector Origin, FVector Direction, float MaxDistance, FF12LatticeHit& OutHit) const
+{
+    return RaycastModulesFiltered(Origin, Direction, MaxDistance, OutHit, [](const FF12GridCoord&, int32) { return true; });
+}
+
+bool AF12GridSystem::RaycastModulesFiltered(FVector Origin, FVector Direction, float MaxDistance, FF12LatticeHit& OutHit,
+    TFunctionRef<bool(const FF12GridCoord&, int32)> IsFaceSolid) const
+{
+    const FVector Dir = Direction.GetSafeNormal();
+    if (Dir.IsZero() || Occupancy.Num() == 0)
+        return false;
+
+    // Work in grid units. Cell C is the set of points P with (P - C) . Offset <= 1 for all
+    // 12 neighbor offsets: the bisector planes towards each neighbor bound the rhombic dodecahedron.
+    // Scaling the direction by the same factor keeps the ray parameter in world units.
+    const double InvSpacing = 1.0 / GetAdjustedSpacing();
+    const FVector Start = Origin * InvSpacing;
+    const FVector Step = Dir * InvSpacing;
+
+    // How fast the ray approaches each face plane (only faces with a positive rate can be exits)
+    double FaceRate[F12Lattice::NumFaces];
+    for (int32 Face = 0; Face < F12Lattice::NumFaces; Face++)
     {
-        float Dot = FVector::DotProduct(HitDirection, Normals[i]);
-        if (Dot > BestDot)
+        const int32* Offset = F12Lattice::NeighborOffsets[Face];
+        FaceRate[Face] = Step.X * Offset[0] + Step.Y * Offset[1] + Step.Z * Offset[2];
+    }
+
+    FIntVector Cell = F12Lattice::NearestLatticePoint(Start.X, Start.Y, Start.Z);
+
+    // Consecutive cells usually share a brick, so keep the last one around
+    FIntVector CachedBrickCoord = FF12OccupancyStore::GetBrickCoord(Cell);
+    const FF12OccupancyBrick* CachedBrick = Occupancy.FindBrick(CachedBrickCoord);
+
+    // Ray parameter where the ray entered the current cell
+    double CurrentT = 0.0;
+
+    // Every step moves forward along the ray; the cap only guards against degenerate input
+    const int32 MaxSteps = 4 * FMath::CeilToInt(MaxDistance * InvSpacing) + 16;
+
+    for (int32 StepIdx = 0; StepIdx < MaxSteps; StepIdx++)
+    {
+        // Empty-space skipping: inside an empty pyramid node, jump to where the ray leaves it.
+        // A point at least one grid unit inside the node's cell box is nearest to a lattice point
+        // in that node (cells reach at most one unit along any axis), so every cell crossed is empty.
+        if (!CachedBrick)
+        {
+            const int32 EmptyLevel = Occupancy.FindEmptyLevel(Cell);
+            if (EmptyLevel != INDEX_NONE)
+            {
+                const FIntVector NodeCoord = FF12OccupancyStore::GetNodeCoord(Cell, EmptyLevel);
+                const int32 NodeSize = FF12OccupancyStore::GetNodeSize(EmptyLevel);
+                const FVector Lo = FVector(NodeCoord.X, NodeCoord.Y, NodeCoord.Z) * NodeSize + FVector(1.0);
+                const FVector Hi = Lo + FVector(NodeSize - 3.0);
+                const FVector Point = Start + Step * CurrentT;
+
+                if (Point.X >= Lo.X && Point.Y >= Lo.Y && Point.Z >= Lo.Z && Point.X <= Hi.X && Point.Y <= Hi.Y && Point.Z <= Hi.Z)
+                {
+                    double SkipT = UE_BIG_NUMBER;
+                    for (int32 Axis = 0; Axis < 3; Axis++)
+                    {
+                        if (Step[Axis] != 0.0)
+                        {
+                            const double Bound = Step[Axis] > 0.0 ? Hi[Axis] : Lo[Axis];
+                            SkipT = FMath::Min(SkipT, (Bound - Start[Axis]) / Step[Axis]);
+                        }
+                    }
+
+                    if (SkipT > MaxDistance)
+                        return false;
+
+                    if (SkipT > CurrentT)
+                    {
+                        const FVector SkipPoint = Start + Step * SkipT;
+                        Cell = F12Lattice::NearestLatticePoint(SkipPoint.X, SkipPoint.Y, SkipPoint.Z);
+                        CurrentT = SkipT;
+                    }
+                }
+            }
+        }
+
+        // Exit through the nearest face plane ahead of the ray
+        const double RelX = Start.X - Cell.X;
+        const double RelY = Start.Y - Cell.Y;
+        const double RelZ = Start.Z - Cell.Z;
+
+        int32 ExitFace = INDEX_NONE;
+        double ExitT = UE_BIG_NUMBER;
+        for (int32 Face = 0; Face < F12Lattice::NumFaces; Face++)
+        {
+            if (FaceRate[Face] <= 0.0)
+                continue;
+
+            const int32* Offset = F12Lattice::NeighborOffsets[Face];
+            const double FaceT = (1.0 - (RelX * Offset[0] + RelY * Offset[1] + RelZ * Offset[2])) / FaceRate[Face];
+            if (FaceT < ExitT)
+            {
+                ExitT = FaceT;
+                ExitFace = Face;
+            }
+        }
+
+        if (ExitFace == INDEX_NONE || ExitT > MaxDistance)
+            return false;
+
+        Cell = F12Lattice::GetNeighbor(Cell, ExitFace);
+
+        const FIntVector BrickCoord = FF12OccupancyStore::GetBrickCoord(Cell);
+        if (BrickCoord != CachedBrickCoord)
         {
-            BestDot = Dot;
-            BestFace = i;
+            CachedBrickCoord = BrickCoord;
+            CachedBrick = Occupancy.FindBrick(BrickCoord);
         }
+
+        // Entered through the face that touches the cell we just left
+        const int32 EntryFace = F12Lattice::OppositeFace[ExitFace];
+        if (CachedBrick && CachedBrick->TestBit(FF12OccupancyStore::GetBitInBrick(Cell)) && IsFaceSolid(FF12GridCoord(Cell), EntryFace))
+        {
+            const double HitT = FMath::Max(ExitT, 0.0);
+            OutHit.Coord = FF12GridCoord(Cell);
+            OutHit.FaceIndex = EntryFace;
+            OutHit.Distance = HitT;
+            OutHit.Location = Origin + Dir * HitT;
+            return true;
+        }
+
+        CurrentT = ExitT;
     }
-    
-    return BestFace;
+
+    return false;
 }
 
 FF12GridCoord AF12GridSystem::GetNeighborCoordForFace(FF12GridCoord ModuleCoord, int32 FaceIndex)
 {
-    TArray<FIntVector> Offsets = GetNeighborOffsets();
-    
-    if (FaceIndex >= 0 && FaceIndex < 12)
+    if (F12Lattice::IsValidFace(FaceIndex))
     {
-        FIntVector Offset = Offsets[FaceIndex];
-        return FF12GridCoord(
-            ModuleCoord.X + Offset.X,
-            ModuleCoord.Y + Offset.Y,
-            ModuleCoord.Z + Offset.Z
-        );
+        return FF12GridCoord(F12Lattice::GetNeighbor(ModuleCoord.ToIntVector(), FaceIndex));
     }
     
     return ModuleCoord;
@@ -182,11 +596,9 @@ FF12GridCoord AF12GridSystem::GetNeighborCoordForFace(FF12GridCoord ModuleCoord,
 
 FVector AF12GridSystem::GetFaceNormal(int32 FaceIndex)
 {
-    TArray<FVector> Normals = GetFaceNormals();
-    
-    if (FaceIndex >= 0 && FaceIndex < 12)
+    if (F12Lattice::IsValidFace(FaceIndex))
     {
-        return Normals[FaceIndex];
+        return F12Lattice::GetFaceNormal(FaceIndex);
     }
     
     return FVector::UpVector;
@@ -194,11 +606,9 @@ FVector AF12GridSystem::GetFaceNormal(int32 FaceIndex)
 
 FIntVector AF12GridSystem::GetGridOffsetForFace(int32 FaceIndex)
 {
-    TArray<FIntVector> Offsets = GetNeighborOffsets();
-    
-    if (FaceIndex >= 0 && FaceIndex < 12)
+    if (F12Lattice::IsValidFace(FaceIndex))
     {
-        return Offsets[FaceIndex];
+        return F12Lattice::GetNeighborOffset(FaceIndex);
     }
     
     return FIntVector(0, 0, 1);  // Default to up
@@ -208,8 +618,5 @@ float AF12GridSystem::GetModuleSpacing() const
 {
     // Distance between adjacent module centers
     // Must account for tile thickness to match GridToWorld
-    float AdjustedSpacing = ModuleSize * 0.707f * (ModuleSize + TileThickness) / ModuleSize;
-    
-    // For BCC lattice, diagonal offsets like (1,0,-1) have magnitude sqrt(2)
-    return AdjustedSpacing * FMath::Sqrt(2.0f);
-}
\ No newline at end of file
+    return F12Lattice::GetModuleSpacing(ModuleSize, TileThickness);
+}
@@ -6,6 +6,11 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "ConvexVolume.h"
+#include "F12OccupancyStore.h"
+#include "F12Connectivity.h"
+#include "F12LatticeKey.h"
+#include "F12LatticeGeometry.h"
 #include "F12GridSystem.generated.h"
 
 // Grid coordinate for a module position
@@ -25,6 +30,14 @@ struct FF12GridCoord
 
     FF12GridCoord() {}
     FF12GridCoord(int32 InX, int32 InY, int32 InZ) : X(InX), Y(InY), Z(InZ) {}
+    explicit FF12GridCoord(const FIntVector& V) : X(V.X), Y(V.Y), Z(V.Z) {}
+
+    FIntVector ToIntVector() const { return FIntVector(X, Y, Z); }
+
+    // Packed Morton key (see F12LatticeKey.h), used by the flat lattice maps
+    uint64 GetLatticeKey() const { return F12LatticeKey::Encode(X, Y, Z); }
+
+    static FF12GridCoord FromLatticeKey(uint64 Key) { return FF12GridCoord(F12LatticeKey::Decode(Key)); }
 
     bool operator==(const FF12GridCoord& Other) const
     {
@@ -38,10 +51,33 @@ struct FF12GridCoord
 
     friend uint32 GetTypeHash(const FF12GridCoord& Coord)
     {
-        return HashCombine(HashCombine(GetTypeHash(Coord.X), GetTypeHash(Coord.Y)), GetTypeHash(Coord.Z));
+        return GetTypeHash(Coord.GetLatticeKey());
     }
 };
 
+// Result of a ray query against the occupied lattice cells
+USTRUCT(BlueprintType)
+struct FF12LatticeHit
+{
+    GENERATED_BODY()
+
+    // Module that was hit
+    UPROPERTY(BlueprintReadOnly)
+    FF12GridCoord Coord;
+
+    // Face of that module the ray entered through (0-11, same indexing as tiles)
+    UPROPERTY(BlueprintReadOnly)
+    int32 FaceIndex = -1;
+
+    // Distance from the ray origin to the entry point
+    UPROPERTY(BlueprintReadOnly)
+    float Distance = 0.0f;
+
+    // World-space entry point
+    UPROPERTY(BlueprintReadOnly)
+    FVector Location = FVector::ZeroVector;
+};
+
 UCLASS()
 class AF12GridSystem : public AActor
 {
@@ -58,7 +94,12 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid")
     float TileThickness = 50.0f;
 
+    // Refuse single-module deletes that would cut the station into separate islands
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid|Connectivity")
+    bool bPreventStationSplit = false;
+
     // Convert world position to nearest grid coordinate
+    // Always returns a valid lattice position (X+Y+Z even)
     UFUNCTION(BlueprintCallable, Category = "Grid")
     FF12GridCoord WorldToGrid(FVector WorldPosition);
 
@@ -66,6 +107,16 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Grid")
     FVector GridToWorld(FF12GridCoord GridCoord);
 
+    // Convert many world positions at once (same result as WorldToGrid per element)
+    // Processes four points per SIMD iteration; use for imports, generators and previews
+    UFUNCTION(BlueprintCallable, Category = "Grid")
+    void WorldToGridBatch(const TArray<FVector>& WorldPositions, TArray<FF12GridCoord>& OutCoords) const;
+
+    // Convert many grid coordinates to world positions at once
+    // Processes four points per SIMD iteration, as three registers over the packed XYZ components
+    UFUNCTION(BlueprintCallable, Category = "Grid")
+    void GridToWorldBatch(const TArray<FF12GridCoord>& GridCoords, TArray<FVector>& OutPositions) const;
+
     // Check if a grid position is occupied
     UFUNCTION(BlueprintCallable, Category = "Grid")
     bool IsOccupied(FF12GridCoord GridCoord);
@@ -78,6 +129,64 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Grid")
     void ClearOccupied(FF12GridCoord GridCoord);
 
+    // Mark many positions as occupied at once (no module actors)
+    // Neighbor masks are recomputed once for the touched bricks instead of per cell
+    // OutAdded receives the positions that were not occupied before
+    UFUNCTION(BlueprintCallable, Category = "Grid")
+    int32 SetOccupiedBulk(const TArray<FF12GridCoord>& GridCoords, TArray<FF12GridCoord>& OutAdded);
+
+    // 12-bit mask of occupied neighbors (bit N = neighbor across face N), 0 if the position is empty
+    // Kept up to date by SetOccupied/ClearOccupied, so this is a single lookup
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Grid")
+    int32 GetNeighborMask(FF12GridCoord GridCoord) const;
+
+    // Recompute all neighbor masks from scratch (parallel over bricks)
+    UFUNCTION(BlueprintCallable, Category = "Grid")
+    void RebuildNeighborMasks();
+
+    // Remove occupancy for many positions at once
+    // Returns the number of positions that were occupied
+    UFUNCTION(BlueprintCallable, Category = "Grid")
+    int32 ClearOccupiedBulk(const TArray<FF12GridCoord>& GridCoords);
+
+    // === REGION QUERIES ===
+    // Occupied modules in a region; whole bricks are culled first, so the cost follows
+    // the modules near the region rather than its volume
+
+    // Modules inside the inclusive grid box [MinCoord, MaxCoord]
+    UFUNCTION(BlueprintCallable, Category = "Grid|Query")
+    void QueryBox(FF12GridCoord MinCoord, FF12GridCoord MaxCoord, TArray<FF12GridCoord>& OutCoords) const;
+
+    // Modules whose center lies within Radius of a world position
+    UFUNCTION(BlueprintCallable, Category = "Grid|Query")
+    void QuerySphere(FVector Center, float Radius, TArray<FF12GridCoord>& OutCoords) const;
+
+    // Modules whose bounding sphere touches a convex volume (e.g. a view frustum)
+    void QueryFrustum(const FConvexVolume& Frustum, TArray<FF12GridCoord>& OutCoords) const;
+
+    // True if no module lies in the inclusive grid box [MinCoord, MaxCoord]
+    // Answered from the coarse occupancy levels, usually without touching any cells
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Grid|Query")
+    bool IsRegionEmpty(FF12GridCoord MinCoord, FF12GridCoord MaxCoord) const;
+
+    // === CONNECTIVITY ===
+
+    // Number of separate groups of face-connected modules (1 = no floating parts)
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Grid|Connectivity")
+    int32 GetIslandCount() const { return Connectivity.GetIslandCount(); }
+
+    // Is this module connected to the core at (0,0,0) through shared faces?
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Grid|Connectivity")
+    bool IsConnectedToCore(FF12GridCoord GridCoord) const;
+
+    // Would removing this module leave some modules disconnected from the rest?
+    UFUNCTION(BlueprintCallable, Category = "Grid|Connectivity")
+    bool WouldRemovalSplit(FF12GridCoord GridCoord) const;
+
+    // All modules that are not connected to the core (empty if the core itself is missing)
+    UFUNCTION(BlueprintCallable, Category = "Grid|Connectivity")
+    TArray<FF12GridCoord> GetFloatingModules() const;
+
     // Get the module at a grid position (nullptr if empty)
     UFUNCTION(BlueprintCallable, Category = "Grid")
     AActor* GetModuleAt(FF12GridCoord GridCoord);
@@ -91,6 +200,17 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Grid")
     int32 GetHitFaceIndex(FF12GridCoord ModuleCoord, FVector HitLocation);
 
+    // Walk the lattice cells along a ray and return the first occupied one (no physics needed)
+    // Each module is treated as its full rhombic dodecahedron cell; the start cell is skipped
+    // Empty coarse occupancy nodes are crossed in one step
+    UFUNCTION(BlueprintCallable, Category = "Grid")
+    bool RaycastModules(FVector Origin, FVector Direction, float MaxDistance, FF12LatticeHit& OutHit) const;
+
+    // RaycastModules, but a module only counts as hit if IsFaceSolid(Coord, EntryFace) is true;
+    // otherwise the ray carries on through it (e.g. past hidden tiles)
+    bool RaycastModulesFiltered(FVector Origin, FVector Direction, float MaxDistance, FF12LatticeHit& OutHit,
+        TFunctionRef<bool(const FF12GridCoord&, int32)> IsFaceSolid) const;
+
     // Get the grid coordinate of the neighboring module for a given face
     UFUNCTION(BlueprintCallable, Category = "Grid")
     FF12GridCoord GetNeighborCoordForFace(FF12GridCoord ModuleCoord, int32 FaceIndex);
@@ -116,11 +236,27 @@ public:
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Grid")
     float GetModuleSpacing() const;
 
+    // Lattice spacing along one grid axis (world units per grid step)
+    float GetAdjustedSpacing() const { return F12Lattice::GetAdjustedSpacing(ModuleSize, TileThickness); }
+
+    // Number of occupied cells
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Grid")
+    int32 GetOccupiedCount() const { return Occupancy.Num(); }
+
     // Get all occupied cells (for iteration)
-    const TMap<FF12GridCoord, AActor*>& GetOccupiedCells() const { return OccupiedPositions; }
+    TArray<FF12GridCoord> GetOccupiedCells() const;
+
+    // Brick-level access to the occupancy data (for chunk iteration)
+    const FF12OccupancyStore& GetOccupancy() const { return Occupancy; }
 
 protected:
-    // Map of occupied positions to module actors
+    // Sparse brick bitset of occupied positions
+    FF12OccupancyStore Occupancy;
+
+    // Island labels, updated with every occupancy change
+    FF12ConnectivityIndex Connectivity;
+
+    // Optional actor per position, only for callers that pass one to SetOccupied
     UPROPERTY()
-    TMap<FF12GridCoord, AActor*> OccupiedPositions;
+    TMap<FF12GridCoord, AActor*> ModuleActors;
 };
\ No newline at end of file
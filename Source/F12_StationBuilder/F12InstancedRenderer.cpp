@@ -4,13 +4,27 @@
 
 #include "F12InstancedRenderer.h"
 #include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "ProceduralMeshComponent.h"
 #include "Components/SceneComponent.h"
 #include "Engine/StaticMesh.h"
 #include "Kismet/GameplayStatics.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/World.h"
+#include "Async/ParallelFor.h"
+#include "Async/Async.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+
+static TAutoConsoleVariable<int32> CVarF12ParallelRebuild(
+    TEXT("F12.Render.ParallelRebuild"),
+    1,
+    TEXT("Build instance transforms for rebuilt chunks on worker threads (0 = game thread only)"));
 
 AF12InstancedRenderer::AF12InstancedRenderer()
 {
-    PrimaryActorTick.bCanEverTick = false;
+    PrimaryActorTick.bCanEverTick = true;
+    PrimaryActorTick.TickGroup = TG_PostUpdateWork;
     
     // Create root component for HISM attachment
     USceneComponent* Root = CreateDefaultSubobject<USceneComponent>(TEXT("RootComponent"));
@@ -57,6 +71,11 @@ void AF12InstancedRenderer::BeginPlay()
     }
 
     NumMaterials = TileMaterials.Num();
+    if (NumMaterials > FF12ModuleStore::MaxMaterial + 1)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("F12InstancedRenderer: %d materials configured, only the first %d can be painted"), NumMaterials, FF12ModuleStore::MaxMaterial + 1);
+        NumMaterials = FF12ModuleStore::MaxMaterial + 1;
+    }
     UE_LOG(LogTemp, Log, TEXT("F12InstancedRenderer: %d materials configured"), NumMaterials);
 
     // Compute face transforms
@@ -72,55 +91,15 @@ void AF12InstancedRenderer::BeginPlay()
 void AF12InstancedRenderer::ComputeFaceTransforms()
 {
     FaceTransforms.Empty();
-    FaceTransforms.SetNum(12);
+    FaceTransforms.SetNum(F12Lattice::NumFaces);
 
-    float R = ModuleSize * 0.5f;
-    float Scale = R / FMath::Sqrt(2.0f);
-    
-    // Define the 14 vertices
-    TArray<FVector> Vertices;
-    Vertices.SetNum(14);
-    
-    // Cubic vertices
-    Vertices[0] = FVector(-1, -1, -1) * Scale;
-    Vertices[1] = FVector( 1, -1, -1) * Scale;
-    Vertices[2] = FVector(-1,  1, -1) * Scale;
-    Vertices[3] = FVector( 1,  1, -1) * Scale;
-    Vertices[4] = FVector(-1, -1,  1) * Scale;
-    Vertices[5] = FVector( 1, -1,  1) * Scale;
-    Vertices[6] = FVector(-1,  1,  1) * Scale;
-    Vertices[7] = FVector( 1,  1,  1) * Scale;
-    
-    // Octahedral vertices
-    Vertices[8]  = FVector( 2,  0,  0) * Scale;
-    Vertices[9]  = FVector(-2,  0,  0) * Scale;
-    Vertices[10] = FVector( 0,  2,  0) * Scale;
-    Vertices[11] = FVector( 0, -2,  0) * Scale;
-    Vertices[12] = FVector( 0,  0,  2) * Scale;
-    Vertices[13] = FVector( 0,  0, -2) * Scale;
-    
-    // Face definitions: [cubic1, octahedral1, cubic2, octahedral2]
-    int32 FaceVertices[12][4] = {
-        {3, 8, 1, 13},   // Face 0
-        {1, 8, 5, 11},   // Face 1
-        {5, 8, 7, 12},   // Face 2
-        {7, 8, 3, 10},   // Face 3
-        {0, 9, 2, 13},   // Face 4
-        {2, 9, 6, 10},   // Face 5
-        {6, 9, 4, 12},   // Face 6
-        {4, 9, 0, 11},   // Face 7
-        {7, 10, 6, 12},  // Face 8
-        {2, 10, 3, 13},  // Face 9
-        {4, 11, 5, 12},  // Face 10
-        {1, 11, 0, 13},  // Face 11
-    };
-    
-    for (int32 FaceIdx = 0; FaceIdx < 12; FaceIdx++)
+    for (int32 FaceIdx = 0; FaceIdx < F12Lattice::NumFaces; FaceIdx++)
     {
-        FVector Cubic1 = Vertices[FaceVertices[FaceIdx][0]];
-        FVector Oct1   = Vertices[FaceVertices[FaceIdx][1]];
-        FVector Cubic2 = Vertices[FaceVertices[FaceIdx][2]];
-        FVector Oct2   = Vertices[FaceVertices[FaceIdx][3]];
+        // Face corners from the shared lattice tables: [cubic1, octahedral1, cubic2, octahedral2]
+        FVector Cubic1 = F12Lattice::GetVertex(F12Lattice::FaceVertices[FaceIdx][0], ModuleSize);
+        FVector Oct1   = F12Lattice::GetVertex(F12Lattice::FaceVertices[FaceIdx][1], ModuleSize);
+        FVector Cubic2 = F12Lattice::GetVertex(F12Lattice::FaceVertices[FaceIdx][2], ModuleSize);
+        FVector Oct2   = F12Lattice::GetVertex(F12Lattice::FaceVertices[FaceIdx][3], ModuleSize);
         
         // Face center
         FVector Center = (Cubic1 + Oct1 + Cubic2 + Oct2) * 0.25f;
@@ -156,14 +135,7 @@ void AF12InstancedRenderer::ComputeFaceTransforms()
 void AF12InstancedRenderer::InitializeHISMComponents()
 {
     // Clear any existing
-    for (auto* HISM : HISMComponents)
-    {
-        if (HISM)
-        {
-            HISM->DestroyComponent();
-        }
-    }
-    HISMComponents.Empty();
+    DestroyChunks();
 
     if (HighlightHISM)
     {
@@ -177,37 +149,26 @@ void AF12InstancedRenderer::InitializeHISMComponents()
         return;
     }
 
-    // Create one HISM per face per material = 12 * NumMaterials
-    int32 TotalComponents = 12 * NumMaterials;
-    HISMComponents.SetNum(TotalComponents);
-
-    for (int32 FaceIdx = 0; FaceIdx < 12; FaceIdx++)
+    if (UsesCustomData())
     {
-        for (int32 MatIdx = 0; MatIdx < NumMaterials; MatIdx++)
+        // One component per chunk for every tile; faces differ by transform, paint by custom data
+        if (!TileMasterMaterial)
         {
-            int32 ComponentIdx = FaceIdx * NumMaterials + MatIdx;
-            
-            UHierarchicalInstancedStaticMeshComponent* HISM = NewObject<UHierarchicalInstancedStaticMeshComponent>(this);
-            HISM->SetStaticMesh(TileStaticMesh);
-            HISM->SetMobility(EComponentMobility::Movable);
-            HISM->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-            HISM->SetCollisionResponseToAllChannels(ECR_Block);
-            HISM->SetCanEverAffectNavigation(false);  // Disable navigation to prevent errors
-            
-            // Set material
-            if (TileMaterials.IsValidIndex(MatIdx) && TileMaterials[MatIdx])
-            {
-                HISM->SetMaterial(0, TileMaterials[MatIdx]);
-            }
-            
-            // Attach and register
-            HISM->AttachToComponent(GetRootComponent(), FAttachmentTransformRules::KeepRelativeTransform);
-            HISM->RegisterComponent();
-            
-            HISMComponents[ComponentIdx] = HISM;
+            UE_LOG(LogTemp, Warning, TEXT("InitializeHISMComponents: CustomData mode without TileMasterMaterial, tiles will use the first tile material"));
         }
+        TileComponentsPerChunk = 1;
+    }
+    else
+    {
+        // One HISM per face per material per chunk = 12 * NumMaterials
+        TileComponentsPerChunk = 12 * NumMaterials;
     }
 
+    // Merged modules get their own components after the tile components (one per material, as tiles)
+    ComponentsPerChunk = TileComponentsPerChunk + (MergedModuleMesh ? (UsesCustomData() ? 1 : NumMaterials) : 0);
+
+    ChunkShift = FMath::CeilLogTwo((uint32)FMath::Clamp(ChunkSize, 1, 256));
+
     // Create highlight HISM (renders on top for delete hover)
     HighlightHISM = NewObject<UHierarchicalInstancedStaticMeshComponent>(this);
     HighlightHISM->SetStaticMesh(TileStaticMesh);
@@ -221,240 +182,1460 @@ void AF12InstancedRenderer::InitializeHISMComponents()
     HighlightHISM->AttachToComponent(GetRootComponent(), FAttachmentTransformRules::KeepRelativeTransform);
     HighlightHISM->RegisterComponent();
 
-    UE_LOG(LogTemp, Log, TEXT("Created %d HISM components (12 faces x %d materials) + 1 highlight. Mesh: %s"), 
-        TotalComponents, NumMaterials, *TileStaticMesh->GetName());
+    UE_LOG(LogTemp, Log, TEXT("Tile components: %d per chunk of %d^3 cells (%s, %d materials) + %d merged module + 1 highlight. Mesh: %s, merged: %s"), 
+        TileComponentsPerChunk, 1 << ChunkShift, UsesCustomData() ? TEXT("custom data") : TEXT("12 faces x materials"), NumMaterials,
+        ComponentsPerChunk - TileComponentsPerChunk, *TileStaticMesh->GetName(), MergedModuleMesh ? *MergedModuleMesh->GetName() : TEXT("none"));
 }
 
-UHierarchicalInstancedStaticMeshComponent* AF12InstancedRenderer::GetHISMForFaceAndMaterial(int32 FaceIndex, int32 MaterialIndex)
+void AF12InstancedRenderer::DestroyChunks()
 {
-    if (FaceIndex < 0 || FaceIndex >= 12)
-        return nullptr;
+    for (auto* HISM : HISMComponents)
+    {
+        if (HISM)
+        {
+            HISM->DestroyComponent();
+        }
+    }
+    for (FF12RenderChunk& Chunk : Chunks)
+    {
+        if (Chunk.HLODMesh)
+        {
+            Chunk.HLODMesh->DestroyComponent();
+        }
+        if (Chunk.ProxyHISM)
+        {
+            Chunk.ProxyHISM->DestroyComponent();
+        }
+    }
+    HISMComponents.Empty();
+    InstanceSources.Empty();
+    ComponentLookup.Reset();
+    Chunks.Empty();
+    ChunkLookup.Reset();
+    PendingTreeBuilds.Reset();
+    QueuedChunks.Reset();
+
+    // Running bakes finish on their own; their results are dropped with the futures
+    HLODBakes.Reset();
+    NumHLODChunks = 0;
+    NumProxyChunks = 0;
+}
+
+UHierarchicalInstancedStaticMeshComponent* AF12InstancedRenderer::CreateTileHISM(UStaticMesh* Mesh, UMaterialInterface* Material, int32 NumCustomDataFloats)
+{
+    UHierarchicalInstancedStaticMeshComponent* HISM = NewObject<UHierarchicalInstancedStaticMeshComponent>(this);
+    HISM->SetStaticMesh(Mesh);
+    HISM->SetMobility(EComponentMobility::Movable);
+    if (bEnableTileCollision)
+    {
+        HISM->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+        HISM->SetCollisionResponseToAllChannels(ECR_Block);
+    }
+    else
+    {
+        HISM->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+    }
+    HISM->SetCanEverAffectNavigation(false);  // Disable navigation to prevent errors
+    HISM->NumCustomDataFloats = NumCustomDataFloats;
+
+    // Trees are built asynchronously from Tick (see MarkTreeOutdated) instead of on every instance change
+    HISM->bAutoRebuildTreeOnInstanceChanges = !bAsyncTreeBuilds;
+
+    // The component only covers its chunk, so this culls the whole chunk at once
+    HISM->LDMaxDrawDistance = ChunkCullDistance;
     
-    MaterialIndex = FMath::Clamp(MaterialIndex, 0, NumMaterials - 1);
-    int32 ComponentIdx = FaceIndex * NumMaterials + MaterialIndex;
+    // Set material (the merged module mesh has one section per tile)
+    if (Material)
+    {
+        for (int32 MaterialSlot = 0; MaterialSlot < FMath::Max(HISM->GetNumMaterials(), 1); MaterialSlot++)
+        {
+            HISM->SetMaterial(MaterialSlot, Material);
+        }
+    }
     
-    if (HISMComponents.IsValidIndex(ComponentIdx))
+    // Attach and register
+    HISM->AttachToComponent(GetRootComponent(), FAttachmentTransformRules::KeepRelativeTransform);
+    HISM->RegisterComponent();
+    return HISM;
+}
+
+UHierarchicalInstancedStaticMeshComponent* AF12InstancedRenderer::GetOrCreateComponent(int32 ComponentIndex)
+{
+    if (!HISMComponents.IsValidIndex(ComponentIndex))
+        return nullptr;
+
+    if (!HISMComponents[ComponentIndex])
+    {
+        const FF12RenderChunk& Chunk = Chunks[ComponentIndex / ComponentsPerChunk];
+        const bool bModuleComponent = IsModuleComponent(ComponentIndex);
+        UMaterialInterface* Material;
+        if (UsesCustomData())
+        {
+            Material = TileMasterMaterial ? TileMasterMaterial : (TileMaterials.Num() > 0 ? TileMaterials[0] : nullptr);
+        }
+        else
+        {
+            const int32 LocalIdx = ComponentIndex % ComponentsPerChunk;
+            const int32 MatIdx = bModuleComponent ? LocalIdx - TileComponentsPerChunk : LocalIdx % NumMaterials;
+            Material = TileMaterials.IsValidIndex(MatIdx) ? TileMaterials[MatIdx] : nullptr;
+        }
+
+        UStaticMesh* Mesh = bModuleComponent ? MergedModuleMesh : (Chunk.TileMesh ? Chunk.TileMesh : TileStaticMesh);
+        UHierarchicalInstancedStaticMeshComponent* HISM = CreateTileHISM(Mesh, Material, UsesCustomData() ? NumTileCustomData : 0);
+        HISM->SetVisibility(Chunk.DrawsInstances());
+        HISMComponents[ComponentIndex] = HISM;
+
+        // Index the component for hit lookups
+        ComponentLookup.Add((uint64)(UPTRINT)HISM, ComponentIndex);
+    }
+    return HISMComponents[ComponentIndex];
+}
+
+// === CHUNKS ===
+
+int32 AF12InstancedRenderer::FindChunkIndex(const FIntVector& Cell) const
+{
+    // Arithmetic shift floors negative coordinates into the correct chunk
+    const FIntVector ChunkCoord(Cell.X >> ChunkShift, Cell.Y >> ChunkShift, Cell.Z >> ChunkShift);
+    const int32* ChunkIdx = F12LatticeKey::IsInRange(ChunkCoord) ? ChunkLookup.Find(F12LatticeKey::Encode(ChunkCoord)) : nullptr;
+    return ChunkIdx ? *ChunkIdx : INDEX_NONE;
+}
+
+int32 AF12InstancedRenderer::FindOrAddChunk(const FIntVector& Cell)
+{
+    const FIntVector ChunkCoord(Cell.X >> ChunkShift, Cell.Y >> ChunkShift, Cell.Z >> ChunkShift);
+    const uint64 ChunkKey = F12LatticeKey::Encode(ChunkCoord);
+    if (const int32* ChunkIdx = ChunkLookup.Find(ChunkKey))
+        return *ChunkIdx;
+
+    // Components are created on first use; reserve their index range now
+    const int32 NewChunkIdx = Chunks.AddDefaulted();
+    Chunks[NewChunkIdx].Coord = ChunkCoord;
+    HISMComponents.AddZeroed(ComponentsPerChunk);
+    InstanceSources.AddDefaulted(ComponentsPerChunk);
+    ChunkLookup.Add(ChunkKey, NewChunkIdx);
+    return NewChunkIdx;
+}
+
+FIntVector AF12InstancedRenderer::GetChunkCoord(FF12GridCoord GridCoord) const
+{
+    return FIntVector(GridCoord.X >> ChunkShift, GridCoord.Y >> ChunkShift, GridCoord.Z >> ChunkShift);
+}
+
+void AF12InstancedRenderer::SetChunkHidden(FIntVector ChunkCoord, bool bHidden)
+{
+    const int32* ChunkIdx = F12LatticeKey::IsInRange(ChunkCoord) ? ChunkLookup.Find(F12LatticeKey::Encode(ChunkCoord)) : nullptr;
+    if (!ChunkIdx || Chunks[*ChunkIdx].bHidden == bHidden)
+        return;
+
+    Chunks[*ChunkIdx].bHidden = bHidden;
+    UpdateChunkVisibility(*ChunkIdx);
+}
+
+void AF12InstancedRenderer::SetChunkCullDistance(float Distance)
+{
+    ChunkCullDistance = FMath::Max(Distance, 0.0f);
+
+    // New components read ChunkCullDistance when they are created
+    for (UHierarchicalInstancedStaticMeshComponent* HISM : HISMComponents)
+    {
+        if (HISM)
+        {
+            HISM->SetCullDistance(ChunkCullDistance);
+        }
+    }
+    for (const FF12RenderChunk& Chunk : Chunks)
+    {
+        if (Chunk.HLODMesh)
+        {
+            Chunk.HLODMesh->SetCullDistance(ChunkCullDistance);
+        }
+        if (Chunk.ProxyHISM)
+        {
+            Chunk.ProxyHISM->SetCullDistance(ChunkCullDistance);
+        }
+    }
+}
+
+void AF12InstancedRenderer::UpdateChunkVisibility(int32 ChunkIndex)
+{
+    const FF12RenderChunk& Chunk = Chunks[ChunkIndex];
+    const bool bDrawInstances = Chunk.DrawsInstances();
+    for (int32 LocalIdx = 0; LocalIdx < ComponentsPerChunk; LocalIdx++)
+    {
+        if (UHierarchicalInstancedStaticMeshComponent* HISM = HISMComponents[ChunkIndex * ComponentsPerChunk + LocalIdx])
+        {
+            HISM->SetVisibility(bDrawInstances);
+        }
+    }
+
+    if (Chunk.HLODMesh)
+    {
+        Chunk.HLODMesh->SetVisibility(!Chunk.bHidden && !Chunk.bShowingProxy && Chunk.bShowingHLOD);
+    }
+    if (Chunk.ProxyHISM)
+    {
+        Chunk.ProxyHISM->SetVisibility(!Chunk.bHidden && Chunk.bShowingProxy);
+    }
+}
+
+bool AF12InstancedRenderer::IsChunkHidden(FIntVector ChunkCoord) const
+{
+    const int32* ChunkIdx = F12LatticeKey::IsInRange(ChunkCoord) ? ChunkLookup.Find(F12LatticeKey::Encode(ChunkCoord)) : nullptr;
+    return ChunkIdx && Chunks[*ChunkIdx].bHidden;
+}
+
+void AF12InstancedRenderer::SetChunkTileMesh(FIntVector ChunkCoord, UStaticMesh* Mesh)
+{
+    const int32* ChunkIdx = F12LatticeKey::IsInRange(ChunkCoord) ? ChunkLookup.Find(F12LatticeKey::Encode(ChunkCoord)) : nullptr;
+    if (!ChunkIdx || Chunks[*ChunkIdx].TileMesh == Mesh)
+        return;
+
+    // Instances keep their transforms; only the mesh they draw changes (merged modules keep theirs)
+    Chunks[*ChunkIdx].TileMesh = Mesh;
+    for (int32 LocalIdx = 0; LocalIdx < TileComponentsPerChunk; LocalIdx++)
+    {
+        if (UHierarchicalInstancedStaticMeshComponent* HISM = HISMComponents[*ChunkIdx * ComponentsPerChunk + LocalIdx])
+        {
+            HISM->SetStaticMesh(Mesh ? Mesh : TileStaticMesh);
+        }
+    }
+}
+
+bool AF12InstancedRenderer::ResolveGridSystem() const
+{
+    // Lazy lookup of GridSystem if not cached
+    if (!GridSystem)
+    {
+        // Cast away const for lazy init
+        AF12InstancedRenderer* MutableThis = const_cast<AF12InstancedRenderer*>(this);
+        MutableThis->GridSystem = Cast<AF12GridSystem>(
+            UGameplayStatics::GetActorOfClass(GetWorld(), AF12GridSystem::StaticClass())
+        );
+        
+        if (!GridSystem)
+        {
+            UE_LOG(LogTemp, Error, TEXT("ResolveGridSystem: No GridSystem found!"));
+            return false;
+        }
+    }
+    return true;
+}
+
+FTransform AF12InstancedRenderer::GetTileWorldTransform(FF12GridCoord GridCoord, int32 TileIndex) const
+{
+    if (TileIndex < 0 || TileIndex >= 12)
+        return FTransform::Identity;
+
+    if (!ResolveGridSystem())
+        return FTransform::Identity;
+
+    // Get module world position
+    return GetTileTransformAtPosition(GridSystem->GridToWorld(GridCoord), TileIndex);
+}
+
+FTransform AF12InstancedRenderer::GetTileTransformAtPosition(const FVector& ModulePos, int32 TileIndex) const
+{
+    // Get face local transform
+    if (!FaceTransforms.IsValidIndex(TileIndex))
     {
-        return HISMComponents[ComponentIdx];
+        UE_LOG(LogTemp, Error, TEXT("GetTileTransformAtPosition: Invalid TileIndex %d, FaceTransforms has %d elements"), 
+            TileIndex, FaceTransforms.Num());
+        return FTransform::Identity;
     }
     
-    return nullptr;
+    // Face transform relative to module center, moved to the module (no rotation or scale to combine)
+    FTransform Result = FaceTransforms[TileIndex];
+    Result.AddToTranslation(ModulePos);
+    return Result;
+}
+
+void AF12InstancedRenderer::Tick(float DeltaSeconds)
+{
+    Super::Tick(DeltaSeconds);
+
+    if (SnapshotPublisher.HasPendingChanges())
+    {
+        PublishSnapshot();
+    }
+
+    if (QueuedChunks.Num() > 0)
+    {
+        ProcessRebuildQueue();
+    }
+
+    UpdateChunkLODs();
+
+    if (PendingTreeBuilds.Num() > 0)
+    {
+        UpdateTreeBuilds();
+    }
+}
+
+// === ASYNC TREE BUILDS ===
+
+void AF12InstancedRenderer::MarkTreeOutdated(int32 ComponentIndex)
+{
+    if (!bAsyncTreeBuilds || PendingTreeBuilds.Contains((uint64)ComponentIndex))
+        return;
+
+    if (PendingTreeBuilds.Num() == 0)
+    {
+        TreeBuildStartTime = FPlatformTime::Seconds();
+        TreeBuildComponents = 0;
+    }
+    PendingTreeBuilds.Add((uint64)ComponentIndex, 0);
+    TreeBuildComponents++;
+}
+
+void AF12InstancedRenderer::UpdateTreeBuilds()
+{
+    TArray<uint64> Finished;
+    PendingTreeBuilds.ForEach([this, &Finished](uint64 ComponentKey, uint8)
+    {
+        UHierarchicalInstancedStaticMeshComponent* HISM = HISMComponents.IsValidIndex((int32)ComponentKey) ? HISMComponents[(int32)ComponentKey] : nullptr;
+        if (!HISM)
+        {
+            Finished.Add(ComponentKey);
+        }
+        else if (!HISM->IsAsyncBuilding())
+        {
+            // Done, or start a worker-thread build (also after an edit that arrived while the previous
+            // build was running); the old tree keeps drawing meanwhile. A tree that cannot be built is dropped.
+            if (HISM->IsTreeFullyBuilt() || !HISM->BuildTreeIfOutdated(true, false))
+            {
+                Finished.Add(ComponentKey);
+            }
+        }
+    });
+
+    for (const uint64 ComponentKey : Finished)
+    {
+        PendingTreeBuilds.Remove(ComponentKey);
+    }
+
+    if (PendingTreeBuilds.Num() == 0)
+    {
+        LastTreeBuildLatencyMs = (FPlatformTime::Seconds() - TreeBuildStartTime) * 1000.0;
+        LastTreeBuildComponents = TreeBuildComponents;
+        if (TreeBuildComponents > 1)
+        {
+            UE_LOG(LogTemp, Log, TEXT("Async tree builds: %d components ready after %.2f ms"), TreeBuildComponents, LastTreeBuildLatencyMs);
+        }
+    }
+}
+
+// === CHUNK HLODS ===
+
+void AF12InstancedRenderer::MarkCellChanged(const FIntVector& Cell)
+{
+    SnapshotPublisher.MarkDirty(Cell);
+    MarkChunkEdited(FindChunkIndex(Cell));
+
+    // A cell on the chunk's border also culls or uncovers faces of modules in the neighboring chunks
+    const int32 LocalMask = (1 << ChunkShift) - 1;
+    const FIntVector Local(Cell.X & LocalMask, Cell.Y & LocalMask, Cell.Z & LocalMask);
+    if (Local.X == 0 || Local.Y == 0 || Local.Z == 0 || Local.X == LocalMask || Local.Y == LocalMask || Local.Z == LocalMask)
+    {
+        for (int32 Face = 0; Face < F12Lattice::NumFaces; Face++)
+        {
+            MarkChunkEdited(FindChunkIndex(F12Lattice::GetNeighbor(Cell, Face)));
+        }
+    }
+}
+
+void AF12InstancedRenderer::MarkChunkEdited(int32 ChunkIndex)
+{
+    if (!Chunks.IsValidIndex(ChunkIndex))
+        return;
+
+    // The instances were kept up to date underneath the baked mesh
+    Chunks[ChunkIndex].EditVersion++;
+    SetChunkShowingHLOD(ChunkIndex, false);
+}
+
+FF12ChunkBakeParams AF12InstancedRenderer::GetHLODBakeParams(int32 ChunkIndex) const
+{
+    FF12ChunkBakeParams Params;
+    Params.ChunkCoord = Chunks[ChunkIndex].Coord;
+    Params.ChunkShift = ChunkShift;
+    Params.Spacing = GridSystem ? GridSystem->GetAdjustedSpacing() : 0.0;
+    Params.ModuleSize = ModuleSize;
+    Params.bCullInteriorFaces = bCullInteriorFaces;
+    Params.NumMaterials = NumMaterials;
+    Params.bPackPaint = UsesCustomData();
+    return Params;
+}
+
+void AF12InstancedRenderer::UpdateChunkLODs()
+{
+    // Take finished bakes; one overtaken by an edit is dropped and the chunk is baked again
+    for (int32 BakeIdx = HLODBakes.Num() - 1; BakeIdx >= 0; BakeIdx--)
+    {
+        FHLODBake& Bake = HLODBakes[BakeIdx];
+        if (!Bake.Result.IsReady())
+            continue;
+
+        FF12RenderChunk& Chunk = Chunks[Bake.ChunkIndex];
+        Chunk.bHLODBaking = false;
+        if (Bake.EditVersion == Chunk.EditVersion)
+        {
+            ApplyHLODBake(Bake.ChunkIndex, Bake.Result.Get());
+            Chunk.HLODVersion = Bake.EditVersion;
+        }
+        HLODBakes.RemoveAtSwap(BakeIdx, 1, EAllowShrinking::No);
+    }
+
+    // A baked mesh drawn with TileMasterMaterial would read zeroed custom data (black, free colour)
+    const bool bHLODs = bChunkHLODs && (!UsesCustomData() || HLODMaterial);
+    const bool bProxies = bFarFieldProxies && GetProxyMesh();
+    FVector ViewLocation;
+    if ((!bHLODs && !bProxies) || !GetViewLocation(ViewLocation) || !ResolveGridSystem())
+    {
+        // Everything back to instances
+        for (int32 ChunkIdx = 0; (NumHLODChunks > 0 || NumProxyChunks > 0) && ChunkIdx < Chunks.Num(); ChunkIdx++)
+        {
+            SetChunkShowingHLOD(ChunkIdx, false);
+            SetChunkShowingProxy(ChunkIdx, false);
+        }
+        return;
+    }
+
+    const double Spacing = GridSystem->GetAdjustedSpacing();
+    const double ChunkWorldSize = (double)(1 << ChunkShift) * Spacing;
+    const double ShowDistSq = FMath::Square((double)HLODDistance);
+    const double KeepDistSq = FMath::Square((double)FMath::Max(HLODDistance - HLODHysteresis, 0.0f));
+
+    // Screen size = bounding sphere diameter / view height at the sphere's distance
+    const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+    const float FOVDegrees = PlayerController && PlayerController->PlayerCameraManager ? PlayerController->PlayerCameraManager->GetFOVAngle() : 90.0f;
+    const double TanHalfFOV = FMath::Tan(FMath::DegreesToRadians(FMath::Clamp(FOVDegrees, 1.0f, 170.0f) * 0.5));
+
+    struct FBakeCandidate
+    {
+        int32 ChunkIndex;
+        double DistSq;
+    };
+    TArray<FBakeCandidate> Candidates;
+
+    for (int32 ChunkIdx = 0; ChunkIdx < Chunks.Num(); ChunkIdx++)
+    {
+        const FF12RenderChunk& Chunk = Chunks[ChunkIdx];
+
+        // Distance to the nearest point of the chunk's modules
+        const FVector Origin = FVector(Chunk.Coord) * ChunkWorldSize;
+        const FBox Bounds = FBox(Origin, Origin + FVector(ChunkWorldSize - Spacing)).ExpandBy(Spacing);
+        const double DistSq = Bounds.ComputeSquaredDistanceToPoint(ViewLocation);
+
+        if (bProxies)
+        {
+            const double Distance = FMath::Max(FVector::Dist(Bounds.GetCenter(), ViewLocation), 1.0);
+            const double ScreenSize = Bounds.GetExtent().Size() / (Distance * TanHalfFOV);
+            const bool bSmall = Chunk.Slots.Num() > 0
+                && ScreenSize < (Chunk.bShowingProxy ? ProxyScreenSize * ProxyScreenSizeHysteresis : ProxyScreenSize);
+
+            // Proxies only depend on occupancy and cost a few instances: rebuild right away
+            if (bSmall && Chunk.ProxyVersion != Chunk.EditVersion)
+            {
+                BuildChunkProxies(ChunkIdx);
+            }
+            SetChunkShowingProxy(ChunkIdx, bSmall);
+        }
+        else
+        {
+            SetChunkShowingProxy(ChunkIdx, false);
+        }
+
+        if (!bHLODs)
+        {
+            SetChunkShowingHLOD(ChunkIdx, false);
+            continue;
+        }
+
+        // Switch out at HLODDistance, back in only inside HLODDistance - HLODHysteresis
+        const bool bCurrent = Chunk.HLODVersion == Chunk.EditVersion;
+        const bool bFar = DistSq > (Chunk.bShowingHLOD ? KeepDistSq : ShowDistSq);
+        SetChunkShowingHLOD(ChunkIdx, bFar && bCurrent);
+
+        // Bake ahead inside the hysteresis band so the mesh is ready when the chunk gets far enough
+        if (!bCurrent && !Chunk.bHLODBaking && Chunk.Slots.Num() > 0 && DistSq > KeepDistSq)
+        {
+            Candidates.Add({ ChunkIdx, DistSq });
+        }
+    }
+
+    // Bakes read the published snapshot, so it has to contain every edit first
+    if (Candidates.Num() == 0 || HLODBakes.Num() >= MaxConcurrentHLODBakes || SnapshotPublisher.HasPendingChanges())
+        return;
+
+    // Nearest chunks are seen first
+    Candidates.Sort([](const FBakeCandidate& A, const FBakeCandidate& B) { return A.DistSq < B.DistSq; });
+
+    const FF12StationSnapshotRef Snapshot = SnapshotPublisher.GetLatest();
+    for (const FBakeCandidate& Candidate : Candidates)
+    {
+        if (HLODBakes.Num() >= MaxConcurrentHLODBakes)
+            break;
+
+        FF12RenderChunk& Chunk = Chunks[Candidate.ChunkIndex];
+        Chunk.bHLODBaking = true;
+
+        FHLODBake& Bake = HLODBakes.AddDefaulted_GetRef();
+        Bake.ChunkIndex = Candidate.ChunkIndex;
+        Bake.EditVersion = Chunk.EditVersion;
+        Bake.Result = Async(EAsyncExecution::ThreadPool, [Snapshot, Params = GetHLODBakeParams(Candidate.ChunkIndex)]()
+        {
+            FF12BakedChunkMesh Mesh;
+            F12ChunkBaker::BakeChunk(*Snapshot, Params, Mesh);
+            return Mesh;
+        });
+    }
+}
+
+void AF12InstancedRenderer::ApplyHLODBake(int32 ChunkIndex, const FF12BakedChunkMesh& Mesh)
+{
+    FF12RenderChunk& Chunk = Chunks[ChunkIndex];
+    if (!Chunk.HLODMesh)
+    {
+        UProceduralMeshComponent* HLODMesh = NewObject<UProceduralMeshComponent>(this);
+        HLODMesh->SetMobility(EComponentMobility::Movable);
+        HLODMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+        HLODMesh->SetCanEverAffectNavigation(false);
+        HLODMesh->LDMaxDrawDistance = ChunkCullDistance;
+        HLODMesh->SetVisibility(false);
+
+        // Baked vertices are relative to the chunk's first cell
+        HLODMesh->AttachToComponent(GetRootComponent(), FAttachmentTransformRules::KeepRelativeTransform);
+        HLODMesh->SetRelativeLocation(F12ChunkBaker::GetChunkOrigin(GetHLODBakeParams(ChunkIndex)));
+        HLODMesh->RegisterComponent();
+        Chunk.HLODMesh = HLODMesh;
+    }
+
+    Chunk.HLODMesh->ClearAllMeshSections();
+    for (int32 SectionIdx = 0; SectionIdx < Mesh.Sections.Num(); SectionIdx++)
+    {
+        const FF12BakedSection& Section = Mesh.Sections[SectionIdx];
+        const TArray<FVector2D> NoUVs;
+        Chunk.HLODMesh->CreateMeshSection(SectionIdx, Section.Vertices, Section.Triangles, Section.Normals, Section.UVs, Section.PaintUVs,
+            NoUVs, NoUVs, Section.Colors, TArray<FProcMeshTangent>(), false);
+
+        // The master material reads per-instance custom data, which a baked mesh has none of
+        UMaterialInterface* Material = UsesCustomData() ? HLODMaterial
+            : TileMaterials.IsValidIndex(Section.MaterialIndex) ? TileMaterials[Section.MaterialIndex] : nullptr;
+        Chunk.HLODMesh->SetMaterial(SectionIdx, Material);
+    }
+}
+
+void AF12InstancedRenderer::SetChunkShowingHLOD(int32 ChunkIndex, bool bShowHLOD)
+{
+    FF12RenderChunk& Chunk = Chunks[ChunkIndex];
+    if (Chunk.bShowingHLOD == bShowHLOD)
+        return;
+
+    Chunk.bShowingHLOD = bShowHLOD;
+    NumHLODChunks += bShowHLOD ? 1 : -1;
+    UpdateChunkVisibility(ChunkIndex);
+}
+
+// === FAR-FIELD PROXIES ===
+
+void AF12InstancedRenderer::BuildChunkProxies(int32 ChunkIndex)
+{
+    FF12RenderChunk& Chunk = Chunks[ChunkIndex];
+    Chunk.ProxyVersion = Chunk.EditVersion;
+
+    UStaticMesh* Mesh = GetProxyMesh();
+    if (!Mesh || !ResolveGridSystem())
+        return;
+
+    if (!Chunk.ProxyHISM)
+    {
+        UHierarchicalInstancedStaticMeshComponent* ProxyHISM = NewObject<UHierarchicalInstancedStaticMeshComponent>(this);
+        ProxyHISM->SetStaticMesh(Mesh);
+        ProxyHISM->SetMobility(EComponentMobility::Movable);
+        ProxyHISM->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+        ProxyHISM->SetCanEverAffectNavigation(false);
+        ProxyHISM->SetCastShadow(false);  // Too small on screen for shadows to matter
+        ProxyHISM->LDMaxDrawDistance = ChunkCullDistance;
+
+        UMaterialInterface* Material = ProxyMaterial ? ProxyMaterial : (TileMaterials.Num() > 0 ? TileMaterials[0] : nullptr);
+        if (Material)
+        {
+            for (int32 MaterialSlot = 0; MaterialSlot < FMath::Max(ProxyHISM->GetNumMaterials(), 1); MaterialSlot++)
+            {
+                ProxyHISM->SetMaterial(MaterialSlot, Material);
+            }
+        }
+
+        ProxyHISM->SetVisibility(false);
+        ProxyHISM->AttachToComponent(GetRootComponent(), FAttachmentTransformRules::KeepRelativeTransform);
+        ProxyHISM->RegisterComponent();
+        Chunk.ProxyHISM = ProxyHISM;
+    }
+
+    // The chunk's cells, and the occupancy bricks covering them
+    const FF12OccupancyStore& Occupancy = GridSystem->GetOccupancy();
+    const double Spacing = GridSystem->GetAdjustedSpacing();
+    const FVector MeshExtent = Mesh->GetBounds().BoxExtent.ComponentMax(FVector(1.0));
+    const FIntVector MinCell(Chunk.Coord.X << ChunkShift, Chunk.Coord.Y << ChunkShift, Chunk.Coord.Z << ChunkShift);
+    const FIntVector MaxCell = MinCell + FIntVector((1 << ChunkShift) - 1);
+    const FIntVector MinBrick = FF12OccupancyStore::GetBrickCoord(MinCell);
+    const FIntVector MaxBrick = FF12OccupancyStore::GetBrickCoord(MaxCell);
+
+    TArray<FTransform> Transforms;
+    for (int32 BZ = MinBrick.Z; BZ <= MaxBrick.Z; BZ++)
+    {
+        for (int32 BY = MinBrick.Y; BY <= MaxBrick.Y; BY++)
+        {
+            for (int32 BX = MinBrick.X; BX <= MaxBrick.X; BX++)
+            {
+                const FF12OccupancyBrick* Brick = Occupancy.FindBrick(FIntVector(BX, BY, BZ));
+                if (!Brick)
+                    continue;
+
+                // Bounds of the brick's occupied cells inside the chunk
+                FIntVector Lo(MAX_int32), Hi(MIN_int32);
+                FF12OccupancyStore::ForEachCellInBrick(*Brick, [&](const FIntVector& Cell)
+                {
+                    if (Cell.X < MinCell.X || Cell.Y < MinCell.Y || Cell.Z < MinCell.Z
+                        || Cell.X > MaxCell.X || Cell.Y > MaxCell.Y || Cell.Z > MaxCell.Z)
+                    {
+                        return;
+                    }
+                    Lo = FIntVector(FMath::Min(Lo.X, Cell.X), FMath::Min(Lo.Y, Cell.Y), FMath::Min(Lo.Z, Cell.Z));
+                    Hi = FIntVector(FMath::Max(Hi.X, Cell.X), FMath::Max(Hi.Y, Cell.Y), FMath::Max(Hi.Z, Cell.Z));
+                });
+                if (Lo.X > Hi.X)
+                    continue;
+
+                // Stretch the proxy over the cell centers plus one module radius (about one spacing)
+                const FVector Center = FVector(Lo + Hi) * (0.5 * Spacing);
+                const FVector Extent = FVector(Hi - Lo) * (0.5 * Spacing) + FVector(Spacing);
+                Transforms.Add(FTransform(FQuat::Identity, Center, Extent / MeshExtent));
+            }
+        }
+    }
+
+    Chunk.ProxyHISM->ClearInstances();
+    if (Transforms.Num() > 0)
+    {
+        Chunk.ProxyHISM->AddInstances(Transforms, false);
+    }
+}
+
+void AF12InstancedRenderer::SetChunkShowingProxy(int32 ChunkIndex, bool bShowProxy)
+{
+    FF12RenderChunk& Chunk = Chunks[ChunkIndex];
+    if (Chunk.bShowingProxy == bShowProxy)
+        return;
+
+    Chunk.bShowingProxy = bShowProxy;
+    NumProxyChunks += bShowProxy ? 1 : -1;
+    UpdateChunkVisibility(ChunkIndex);
+}
+
+// === SNAPSHOTS ===
+
+void AF12InstancedRenderer::PublishSnapshot()
+{
+    if (!ResolveGridSystem())
+        return;
+
+    const FF12OccupancyStore& Occupancy = GridSystem->GetOccupancy();
+
+    // Occupancy comes from the grid, tiles from Modules; only dirty bricks are visited
+    SnapshotPublisher.Publish([this, &Occupancy](const FIntVector& BrickCoord, FF12SnapshotChunk& OutChunk)
+    {
+        const FF12OccupancyBrick* Brick = Occupancy.FindBrick(BrickCoord);
+        if (!Brick)
+            return;
+
+        OutChunk.Cells = *Brick;
+        OutChunk.Modules.Reserve(Brick->Count);
+
+        FF12OccupancyStore::ForEachCellInBrick(*Brick, [this, &OutChunk](const FIntVector& Cell)
+        {
+            FF12SnapshotModule& Module = OutChunk.Modules.AddDefaulted_GetRef();
+            const int32 Slot = Modules.Find(Cell);
+            if (Slot != INDEX_NONE)
+            {
+                for (int32 Tile = 0; Tile < F12Lattice::NumFaces; Tile++)
+                {
+                    Module.TileMaterials[Tile] = (uint8)Modules.GetMaterial(Slot, Tile);
+                    Module.TileColors[Tile] = Modules.GetTileColor(Slot, Tile);
+                }
+                Module.VisibleTiles = Modules.GetVisibleMask(Slot);
+                Module.ColoredTiles = Modules.GetColoredMask(Slot);
+            }
+        });
+    });
+}
+
+// === MODULE MANAGEMENT ===
+
+void AF12InstancedRenderer::AddModule(FF12GridCoord GridCoord, int32 MaterialIndex)
+{
+    if (Modules.Contains(GridCoord.ToIntVector()))
+        return;  // Already exists
+
+    if (!F12LatticeKey::IsStorableCell(GridCoord.ToIntVector()))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("AddModule: (%d,%d,%d) is outside the lattice key range"), GridCoord.X, GridCoord.Y, GridCoord.Z);
+        return;
+    }
+    if (!FF12OccupancyStore::IsLatticeCell(GridCoord.ToIntVector()))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("AddModule: (%d,%d,%d) has odd parity and is not a lattice point"), GridCoord.X, GridCoord.Y, GridCoord.Z);
+        return;
+    }
+
+    // Validate the renderer is set up (tile components are created per chunk on demand)
+    if (FaceTransforms.Num() == 0)
+    {
+        UE_LOG(LogTemp, Error, TEXT("AddModule: Renderer not initialized! Was BeginPlay called?"));
+        return;
+    }
+
+    // Create module data
+    const int32 Slot = Modules.Add(GridCoord.ToIntVector(), MaterialIndex);
+    const int32 ChunkIdx = FindOrAddChunk(GridCoord.ToIntVector());
+    Chunks[ChunkIdx].Slots.Add(Slot);
+    
+    MarkCellChanged(GridCoord.ToIntVector());
+
+    if (IsInEditBatch())
+    {
+        // Instances (ours and the neighbors') are created when the batch commits
+        LinkNeighbors(Slot, false);
+        MarkModuleDirty(Slot);
+        return;
+    }
+
+    // Hide the faces pressed against existing modules (on both sides)
+    LinkNeighbors(Slot);
+    
+    int32 InstancesAdded = 0;
+
+    // A fresh module is uniform: unless neighbors enclose it, one merged instance covers all of its tiles
+    if (WantsMergedInstance(Slot) && AddMergedInstance(Slot))
+    {
+        InstancesAdded++;
+    }
+    
+    // Add instances for each visible tile
+    for (int32 TileIdx = 0; TileIdx < 12; TileIdx++)
+    {
+        if (IsTileRendered(Slot, TileIdx))
+        {
+            if (AddTileInstance(Slot, TileIdx))
+            {
+                InstancesAdded++;
+            }
+            else
+            {
+                UE_LOG(LogTemp, Warning, TEXT("AddModule: No HISM for face %d, material %d"), TileIdx, MaterialIndex);
+            }
+        }
+    }
+    
+    UE_LOG(LogTemp, Log, TEXT("AddModule at (%d,%d,%d): Added %d instances, Total modules: %d"), 
+        GridCoord.X, GridCoord.Y, GridCoord.Z, InstancesAdded, Modules.Num());
+}
+
+void AF12InstancedRenderer::AddModulesBulk(const TArray<FF12GridCoord>& GridCoords, int32 MaterialIndex)
+{
+    FF12ScopedEditBatch Batch(this);
+    Modules.Reserve(Modules.Num() + GridCoords.Num());
+
+    for (const FF12GridCoord& Coord : GridCoords)
+    {
+        AddModule(Coord, MaterialIndex);
+    }
+}
+
+void AF12InstancedRenderer::RemoveModule(FF12GridCoord GridCoord)
+{
+    const int32 Slot = Modules.Find(GridCoord.ToIntVector());
+    if (Slot == INDEX_NONE)
+        return;
+
+    // The slot may be reused right away, so its instances have to go now (unless its chunk is rebuilt anyway)
+    const int32 ChunkIdx = GetSlotChunk(Slot);
+    if (!IsChunkRebuildPending(ChunkIdx))
+    {
+        RemoveModuleInstances(Slot);
+    }
+    UnlinkNeighbors(Slot, !IsInEditBatch());
+    Chunks[ChunkIdx].Slots.RemoveSingleSwap(Slot, EAllowShrinking::No);
+    Modules.Remove(GridCoord.ToIntVector());
+    BatchDirtySlots.Remove((uint64)Slot);
+    MarkCellChanged(GridCoord.ToIntVector());
+}
+
+void AF12InstancedRenderer::RemoveModulesBulk(const TArray<FF12GridCoord>& GridCoords)
+{
+    FF12ScopedEditBatch Batch(this);
+
+    // Past this share of a chunk, one rebuild of the chunk beats moving instances one at a time
+    TF12FlatMap<int32> RemovedPerChunk;
+    for (const FF12GridCoord& Coord : GridCoords)
+    {
+        const int32 ChunkIdx = FindChunkIndex(Coord.ToIntVector());
+        if (ChunkIdx != INDEX_NONE && Modules.Contains(Coord.ToIntVector()))
+        {
+            RemovedPerChunk.FindOrAdd((uint64)ChunkIdx)++;
+        }
+    }
+    RemovedPerChunk.ForEach([this](uint64 ChunkKey, int32 NumRemoved)
+    {
+        if (NumRemoved * 4 > Chunks[(int32)ChunkKey].Slots.Num())
+        {
+            BatchRebuildChunks.FindOrAdd(ChunkKey);
+        }
+    });
+
+    for (const FF12GridCoord& Coord : GridCoords)
+    {
+        RemoveModule(Coord);
+    }
+}
+
+// === EDIT BATCHES ===
+
+void AF12InstancedRenderer::BeginEditBatch()
+{
+    EditBatchDepth++;
+}
+
+void AF12InstancedRenderer::EndEditBatch()
+{
+    if (EditBatchDepth == 0)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("EndEditBatch called without a matching BeginEditBatch"));
+        return;
+    }
+
+    if (--EditBatchDepth > 0)
+        return;
+
+    // Group the changed modules by chunk
+    TF12FlatMap<int32> DirtyPerChunk;
+    BatchDirtySlots.ForEach([this, &DirtyPerChunk](uint64 SlotKey, uint8)
+    {
+        DirtyPerChunk.FindOrAdd((uint64)GetSlotChunk((int32)SlotKey))++;
+    });
+
+    // Chunks with a large share of changed modules are rebuilt whole
+    DirtyPerChunk.ForEach([this](uint64 ChunkKey, int32 NumDirty)
+    {
+        if (NumDirty * 4 > Chunks[(int32)ChunkKey].Slots.Num())
+        {
+            BatchRebuildChunks.FindOrAdd(ChunkKey);
+        }
+    });
+    TArray<int32> RebuildList;
+    RebuildList.Reserve(BatchRebuildChunks.Num());
+    BatchRebuildChunks.ForEach([&RebuildList](uint64 ChunkKey, uint8)
+    {
+        RebuildList.Add((int32)ChunkKey);
+    });
+    RebuildOrQueueChunks(RebuildList);
+
+    // In the other chunks only the changed modules are synced
+    TF12FlatMap<uint8> CustomDataChunks;
+    int32 NumSynced = 0;
+    BatchDirtySlots.ForEach([this, &CustomDataChunks, &NumSynced](uint64 SlotKey, uint8)
+    {
+        const int32 ChunkIdx = GetSlotChunk((int32)SlotKey);
+        if (IsChunkRebuildPending(ChunkIdx))
+            return;
+
+        if (SyncModuleInstances((int32)SlotKey))
+        {
+            CustomDataChunks.FindOrAdd((uint64)ChunkIdx);
+        }
+        NumSynced++;
+    });
+
+    CustomDataChunks.ForEach([this](uint64 ChunkKey, uint8)
+    {
+        for (int32 LocalIdx = 0; LocalIdx < ComponentsPerChunk; LocalIdx++)
+        {
+            if (UHierarchicalInstancedStaticMeshComponent* HISM = HISMComponents[(int32)ChunkKey * ComponentsPerChunk + LocalIdx])
+            {
+                HISM->MarkRenderStateDirty();
+            }
+        }
+    });
+
+    if (BatchDirtySlots.Num() > 0 || BatchRebuildChunks.Num() > 0)
+    {
+        UE_LOG(LogTemp, Log, TEXT("EndEditBatch: %d chunks rebuilt, %d modules synced, total modules: %d"), BatchRebuildChunks.Num(), NumSynced, Modules.Num());
+    }
+
+    BatchDirtySlots.Reset();
+    BatchRebuildChunks.Reset();
+}
+
+bool AF12InstancedRenderer::SyncModuleInstances(int32 Slot)
+{
+    bool bCustomDataWritten = false;
+
+    // A module that stopped being uniform leaves its merged instance; if it became uniform,
+    // IsTileRendered is false for every tile and the loop below removes the tile instances
+    const bool bMerged = WantsMergedInstance(Slot);
+    if (!bMerged)
+    {
+        RemoveMergedInstance(Slot);
+    }
+
+    for (int32 TileIdx = 0; TileIdx < 12; TileIdx++)
+    {
+        const int32 InstanceIdx = Modules.GetInstanceIndex(Slot, TileIdx);
+        const bool bWanted = IsTileRendered(Slot, TileIdx);
+
+        if (InstanceIdx == INDEX_NONE)
+        {
+            if (bWanted)
+            {
+                AddTileInstance(Slot, TileIdx);
+            }
+        }
+        else if (!bWanted)
+        {
+            RemoveTileInstanceOf(Slot, TileIdx);
+        }
+        else if (UsesCustomData())
+        {
+            // Paint may have changed while deferred; the instance is already in the right component
+            WriteTileCustomData(HISMComponents[GetTileComponentIndex(Slot, TileIdx)], InstanceIdx, Slot, TileIdx, false);
+            bCustomDataWritten = true;
+        }
+    }
+
+    if (bMerged)
+    {
+        const int32 ModuleInstanceIdx = Modules.GetModuleInstanceIndex(Slot);
+        if (ModuleInstanceIdx == INDEX_NONE)
+        {
+            AddMergedInstance(Slot);
+        }
+        else if (UsesCustomData())
+        {
+            // Every tile has the same paint, so tile 0 speaks for the module
+            WriteTileCustomData(HISMComponents[GetModuleComponentIndex(GetSlotChunk(Slot), Modules.GetMaterial(Slot, 0))], ModuleInstanceIdx, Slot, 0, false);
+            bCustomDataWritten = true;
+        }
+    }
+    return bCustomDataWritten;
+}
+
+// === INTERIOR FACE CULLING ===
+
+bool AF12InstancedRenderer::WantsMergedInstance(int32 Slot) const
+{
+    if (ComponentsPerChunk == TileComponentsPerChunk || !Modules.IsUniform(Slot))
+        return false;
+
+    return !bCullInteriorFaces || FMath::CountBits(Modules.GetCulledMask(Slot)) <= MaxMergedCulledFaces;
+}
+
+bool AF12InstancedRenderer::IsTileRendered(int32 Slot, int32 TileIndex) const
+{
+    return Modules.IsVisible(Slot, TileIndex) && !(bCullInteriorFaces && Modules.IsCulled(Slot, TileIndex)) && !WantsMergedInstance(Slot);
+}
+
+void AF12InstancedRenderer::SetFaceCulled(int32 Slot, int32 Face, bool bCulled, bool bUpdateInstances)
+{
+    if (Modules.IsCulled(Slot, Face) == bCulled)
+        return;
+
+    const bool bWasMerged = WantsMergedInstance(Slot);
+    if (bUpdateInstances && bCulled && !bWasMerged)
+    {
+        RemoveTileInstanceOf(Slot, Face);
+    }
+
+    Modules.SetCulled(Slot, Face, bCulled);
+    NumCulledFaces += bCulled ? 1 : -1;
+
+    if (!bUpdateInstances && IsInEditBatch())
+    {
+        MarkModuleDirty(Slot);
+    }
+
+    if (!bUpdateInstances)
+        return;
+
+    // The module crossed MaxMergedCulledFaces: split it into tile instances or merge it again
+    if (bWasMerged != WantsMergedInstance(Slot))
+    {
+        SyncModuleInstances(Slot);
+    }
+    else if (!bWasMerged && !bCulled && IsTileRendered(Slot, Face))
+    {
+        AddTileInstance(Slot, Face);
+    }
+}
+
+void AF12InstancedRenderer::LinkNeighbors(int32 Slot, bool bUpdateInstances)
+{
+    const FIntVector Cell = Modules.GetCell(Slot);
+    for (int32 Face = 0; Face < F12Lattice::NumFaces; Face++)
+    {
+        const int32 NeighborSlot = Modules.Find(F12Lattice::GetNeighbor(Cell, Face));
+        if (NeighborSlot != INDEX_NONE)
+        {
+            // The new module has no instances yet; the caller creates them from the final mask
+            SetFaceCulled(Slot, Face, true, false);
+            SetFaceCulled(NeighborSlot, F12Lattice::OppositeFace[Face], true, bUpdateInstances);
+        }
+    }
+}
+
+void AF12InstancedRenderer::UnlinkNeighbors(int32 Slot, bool bUpdateInstances)
+{
+    const FIntVector Cell = Modules.GetCell(Slot);
+    for (int32 Face = 0; Face < F12Lattice::NumFaces; Face++)
+    {
+        // The module itself is going away, so only its count needs to follow
+        SetFaceCulled(Slot, Face, false, false);
+
+        const int32 NeighborSlot = Modules.Find(F12Lattice::GetNeighbor(Cell, Face));
+        if (NeighborSlot != INDEX_NONE)
+        {
+            SetFaceCulled(NeighborSlot, F12Lattice::OppositeFace[Face], false, bUpdateInstances);
+        }
+    }
+}
+
+// === INSTANCE BOOKKEEPING ===
+
+bool AF12InstancedRenderer::AddTileInstance(int32 Slot, int32 TileIndex)
+{
+    // The chunk's rebuild will create the instance
+    if (IsChunkRebuildPending(GetSlotChunk(Slot)))
+        return true;
+
+    const int32 ComponentIdx = GetTileComponentIndex(Slot, TileIndex);
+    UHierarchicalInstancedStaticMeshComponent* HISM = GetOrCreateComponent(ComponentIdx);
+    if (!HISM)
+        return false;
+
+    const FF12GridCoord GridCoord(Modules.GetCell(Slot));
+    const int32 InstanceIdx = HISM->AddInstance(GetTileWorldTransform(GridCoord, TileIndex), true);
+    Modules.SetInstanceIndex(Slot, TileIndex, InstanceIdx);
+    MarkTreeOutdated(ComponentIdx);
+    if (UsesCustomData())
+    {
+        WriteTileCustomData(HISM, InstanceIdx, Slot, TileIndex, true);
+    }
+
+    // Track this instance -> source mapping
+    SetInstanceSource(ComponentIdx, InstanceIdx, Slot, TileIndex);
+    return true;
+}
+
+void AF12InstancedRenderer::SetInstanceSource(int32 ComponentIndex, int32 InstanceIndex, int32 Slot, int32 TileIndex)
+{
+    TArray<int32>& Sources = InstanceSources[ComponentIndex];
+    if (InstanceIndex >= Sources.Num())
+    {
+        Sources.SetNumUninitialized(InstanceIndex + 1);
+    }
+    Sources[InstanceIndex] = Slot * FF12ModuleStore::NumTiles + TileIndex;
+}
+
+void AF12InstancedRenderer::RemoveTileInstanceOf(int32 Slot, int32 TileIndex)
+{
+    // The chunk's rebuild drops the instance (its components are not touched until then)
+    if (IsChunkRebuildPending(GetSlotChunk(Slot)))
+        return;
+
+    const int32 InstanceIdx = Modules.GetInstanceIndex(Slot, TileIndex);
+    if (InstanceIdx != INDEX_NONE)
+    {
+        RemoveTileInstance(GetTileComponentIndex(Slot, TileIndex), InstanceIdx);
+        Modules.SetInstanceIndex(Slot, TileIndex, INDEX_NONE);
+    }
+}
+
+int32 AF12InstancedRenderer::GetComponentIndex(int32 ChunkIndex, int32 TileIndex, int32 MaterialIndex) const
+{
+    if (UsesCustomData())
+        return ChunkIndex * ComponentsPerChunk;
+
+    return ChunkIndex * ComponentsPerChunk + TileIndex * NumMaterials + FMath::Clamp(MaterialIndex, 0, NumMaterials - 1);
+}
+
+int32 AF12InstancedRenderer::GetTileComponentIndex(int32 Slot, int32 TileIndex) const
+{
+    return GetComponentIndex(GetSlotChunk(Slot), TileIndex, Modules.GetMaterial(Slot, TileIndex));
+}
+
+// === MERGED MODULES ===
+
+int32 AF12InstancedRenderer::GetModuleComponentIndex(int32 ChunkIndex, int32 MaterialIndex) const
+{
+    const int32 FirstModuleComponent = ChunkIndex * ComponentsPerChunk + TileComponentsPerChunk;
+    return UsesCustomData() ? FirstModuleComponent : FirstModuleComponent + FMath::Clamp(MaterialIndex, 0, NumMaterials - 1);
+}
+
+bool AF12InstancedRenderer::AddMergedInstance(int32 Slot)
+{
+    // The chunk's rebuild will create the instance
+    const int32 ChunkIdx = GetSlotChunk(Slot);
+    if (IsChunkRebuildPending(ChunkIdx))
+        return true;
+
+    const int32 ComponentIdx = GetModuleComponentIndex(ChunkIdx, Modules.GetMaterial(Slot, 0));
+    UHierarchicalInstancedStaticMeshComponent* HISM = GetOrCreateComponent(ComponentIdx);
+    if (!HISM || !ResolveGridSystem())
+        return false;
+
+    // The merged mesh is modelled around the module center, unrotated
+    const FTransform ModuleTransform(GridSystem->GridToWorld(FF12GridCoord(Modules.GetCell(Slot))));
+    const int32 InstanceIdx = HISM->AddInstance(ModuleTransform, true);
+    Modules.SetModuleInstanceIndex(Slot, InstanceIdx);
+    MarkTreeOutdated(ComponentIdx);
+    if (UsesCustomData())
+    {
+        WriteTileCustomData(HISM, InstanceIdx, Slot, 0, true);
+    }
+
+    // Tile 0 stands for the whole module in the source table
+    SetInstanceSource(ComponentIdx, InstanceIdx, Slot, 0);
+    return true;
+}
+
+void AF12InstancedRenderer::RemoveMergedInstance(int32 Slot)
+{
+    const int32 ChunkIdx = GetSlotChunk(Slot);
+    if (IsChunkRebuildPending(ChunkIdx))
+        return;
+
+    const int32 InstanceIdx = Modules.GetModuleInstanceIndex(Slot);
+    if (InstanceIdx != INDEX_NONE)
+    {
+        RemoveTileInstance(GetModuleComponentIndex(ChunkIdx, Modules.GetMaterial(Slot, 0)), InstanceIdx);
+        Modules.SetModuleInstanceIndex(Slot, INDEX_NONE);
+    }
+}
+
+void AF12InstancedRenderer::GetTileCustomData(int32 Slot, int32 TileIndex, float* OutCustomData) const
+{
+    OutCustomData[0] = (float)FMath::Clamp(Modules.GetMaterial(Slot, TileIndex), 0, NumMaterials - 1);
+    OutCustomData[1] = 0.0f;
+    OutCustomData[2] = 0.0f;
+    OutCustomData[3] = 0.0f;
+    OutCustomData[4] = -1.0f;
+    if (Modules.HasTileColor(Slot, TileIndex))
+    {
+        const uint32 PackedColor = Modules.GetTileColor(Slot, TileIndex);
+        const FLinearColor Color = F12TilePaint::UnpackColor(PackedColor);
+        OutCustomData[1] = Color.R;
+        OutCustomData[2] = Color.G;
+        OutCustomData[3] = Color.B;
+        OutCustomData[4] = F12TilePaint::UnpackRoughness(PackedColor);
+    }
+}
+
+void AF12InstancedRenderer::WriteTileCustomData(UHierarchicalInstancedStaticMeshComponent* HISM, int32 InstanceIndex, int32 Slot, int32 TileIndex, bool bMarkRenderStateDirty)
+{
+    float CustomData[NumTileCustomData];
+    GetTileCustomData(Slot, TileIndex, CustomData);
+    HISM->SetCustomData(InstanceIndex, MakeArrayView(CustomData, NumTileCustomData), bMarkRenderStateDirty);
 }
 
-FTransform AF12InstancedRenderer::GetTileWorldTransform(FF12GridCoord GridCoord, int32 TileIndex) const
+void AF12InstancedRenderer::ApplyTileMaterial(int32 Slot, int32 TileIndex, int32 MaterialIndex)
 {
-    if (TileIndex < 0 || TileIndex >= 12)
-        return FTransform::Identity;
+    if (MergedModuleMesh && !IsInEditBatch())
+    {
+        // The module may split into tiles or merge back; the commit syncs all of its instances
+        FF12ScopedEditBatch Batch(this);
+        ApplyTileMaterial(Slot, TileIndex, MaterialIndex);
+        return;
+    }
 
-    // Lazy lookup of GridSystem if not cached
-    if (!GridSystem)
+    Modules.ClearTileColor(Slot, TileIndex);
+
+    if (IsInEditBatch())
     {
-        // Cast away const for lazy init
-        AF12InstancedRenderer* MutableThis = const_cast<AF12InstancedRenderer*>(this);
-        MutableThis->GridSystem = Cast<AF12GridSystem>(
-            UGameplayStatics::GetActorOfClass(GetWorld(), AF12GridSystem::StaticClass())
-        );
-        
-        if (!GridSystem)
+        // An instance must always sit in its material's component: pull it out now (the commit
+        // adds it back) unless only custom data changes or the chunk is rebuilt anyway.
+        // The merged instance is found through tile 0's material, so it goes too.
+        if (!UsesCustomData() && !IsChunkRebuildPending(GetSlotChunk(Slot)))
         {
-            UE_LOG(LogTemp, Error, TEXT("GetTileWorldTransform: No GridSystem found!"));
-            return FTransform::Identity;
+            RemoveTileInstanceOf(Slot, TileIndex);
+            RemoveMergedInstance(Slot);
         }
+        Modules.SetMaterial(Slot, TileIndex, MaterialIndex);
+        MarkModuleDirty(Slot);
+        return;
     }
 
-    // Get module world position
-    FVector ModulePos = GridSystem->GridToWorld(GridCoord);
-    
-    // Get face local transform
-    if (!FaceTransforms.IsValidIndex(TileIndex))
+    const int32 InstanceIdx = Modules.GetInstanceIndex(Slot, TileIndex);
+    if (UsesCustomData() && InstanceIdx != INDEX_NONE)
     {
-        UE_LOG(LogTemp, Error, TEXT("GetTileWorldTransform: Invalid TileIndex %d, FaceTransforms has %d elements"), 
-            TileIndex, FaceTransforms.Num());
-        return FTransform::Identity;
+        // Same component either way: just rewrite the instance's custom data
+        Modules.SetMaterial(Slot, TileIndex, MaterialIndex);
+        WriteTileCustomData(HISMComponents[GetTileComponentIndex(Slot, TileIndex)], InstanceIdx, Slot, TileIndex, true);
+        return;
     }
-    
-    FTransform FaceLocal = FaceTransforms[TileIndex];
-    
-    // Combine: face transform relative to module center
-    FTransform ModuleTransform(FQuat::Identity, ModulePos, FVector::OneVector);
-    
-    FTransform Result = FaceLocal * ModuleTransform;
-    
-    return Result;
-}
 
-// === MODULE MANAGEMENT ===
+    // Move the tile's instance (if rendered) from the old material's component to the new one
+    RemoveTileInstanceOf(Slot, TileIndex);
+    Modules.SetMaterial(Slot, TileIndex, MaterialIndex);
+    if (IsTileRendered(Slot, TileIndex))
+    {
+        AddTileInstance(Slot, TileIndex);
+    }
+}
 
-void AF12InstancedRenderer::AddModule(FF12GridCoord GridCoord, int32 MaterialIndex)
+bool AF12InstancedRenderer::ApplyTileColor(int32 Slot, int32 TileIndex, uint32 PackedColor)
 {
-    if (ModuleData.Contains(GridCoord))
-        return;  // Already exists
+    if (Modules.HasTileColor(Slot, TileIndex) && Modules.GetTileColor(Slot, TileIndex) == PackedColor)
+        return false;
 
-    // Validate we have HISM components
-    if (HISMComponents.Num() == 0)
+    if (MergedModuleMesh && !IsInEditBatch())
     {
-        UE_LOG(LogTemp, Error, TEXT("AddModule: No HISM components! Was BeginPlay called?"));
-        return;
+        // A coloured tile splits a merged module; the commit syncs all of its instances
+        FF12ScopedEditBatch Batch(this);
+        return ApplyTileColor(Slot, TileIndex, PackedColor);
     }
 
-    // Create module data
-    FF12ModuleInstanceData Data;
-    for (int32 i = 0; i < 12; i++)
+    Modules.SetTileColor(Slot, TileIndex, PackedColor);
+
+    if (IsInEditBatch())
     {
-        Data.TileMaterials[i] = MaterialIndex;
-        Data.TileVisibility[i] = true;
+        MarkModuleDirty(Slot);
+        return true;
     }
-    
-    ModuleData.Add(GridCoord, Data);
-    
-    int32 InstancesAdded = 0;
-    
-    // Add instances for each visible tile
-    for (int32 TileIdx = 0; TileIdx < 12; TileIdx++)
+
+    // The instance stays where it is; only its custom data changes
+    const int32 InstanceIdx = Modules.GetInstanceIndex(Slot, TileIndex);
+    if (UsesCustomData() && InstanceIdx != INDEX_NONE)
     {
-        if (Data.TileVisibility[TileIdx])
-        {
-            UHierarchicalInstancedStaticMeshComponent* HISM = GetHISMForFaceAndMaterial(TileIdx, MaterialIndex);
-            if (HISM)
-            {
-                FTransform TileTransform = GetTileWorldTransform(GridCoord, TileIdx);
-                int32 InstanceIdx = HISM->AddInstance(TileTransform, true);
-                
-                // Track this instance -> source mapping
-                int32 ComponentIdx = TileIdx * NumMaterials + FMath::Clamp(MaterialIndex, 0, NumMaterials - 1);
-                FF12InstanceKey Key(ComponentIdx, InstanceIdx);
-                InstanceToSourceMap.Add(Key, FF12InstanceSourceData(GridCoord, TileIdx));
-                
-                InstancesAdded++;
-            }
-            else
-            {
-                UE_LOG(LogTemp, Warning, TEXT("AddModule: No HISM for face %d, material %d"), TileIdx, MaterialIndex);
-            }
-        }
+        WriteTileCustomData(HISMComponents[GetTileComponentIndex(Slot, TileIndex)], InstanceIdx, Slot, TileIndex, true);
     }
-    
-    UE_LOG(LogTemp, Log, TEXT("AddModule at (%d,%d,%d): Added %d instances, Total modules: %d"), 
-        GridCoord.X, GridCoord.Y, GridCoord.Z, InstancesAdded, ModuleData.Num());
+    return true;
 }
 
-void AF12InstancedRenderer::AddModulesBulk(const TArray<FF12GridCoord>& GridCoords, int32 MaterialIndex)
+void AF12InstancedRenderer::RemoveModuleInstances(int32 Slot)
 {
-    for (const FF12GridCoord& Coord : GridCoords)
+    RemoveMergedInstance(Slot);
+
+    // The instance moved into a freed slot may be another tile of this module (single
+    // component in CustomData mode); RemoveTileInstance patches its index before we reach it
+    for (int32 TileIdx = 0; TileIdx < 12; TileIdx++)
     {
-        if (!ModuleData.Contains(Coord))
-        {
-            FF12ModuleInstanceData Data;
-            for (int32 i = 0; i < 12; i++)
-            {
-                Data.TileMaterials[i] = MaterialIndex;
-                Data.TileVisibility[i] = true;
-            }
-            ModuleData.Add(Coord, Data);
-        }
+        RemoveTileInstanceOf(Slot, TileIdx);
     }
-    
-    // Rebuild all instances (more efficient for bulk adds)
-    RebuildInstances();
 }
 
-void AF12InstancedRenderer::RemoveModule(FF12GridCoord GridCoord)
+void AF12InstancedRenderer::RemoveTileInstance(int32 ComponentIndex, int32 InstanceIndex)
 {
-    if (!ModuleData.Contains(GridCoord))
+    UHierarchicalInstancedStaticMeshComponent* HISM = HISMComponents.IsValidIndex(ComponentIndex) ? HISMComponents[ComponentIndex] : nullptr;
+    if (!HISM || !HISM->IsValidInstance(InstanceIndex))
         return;
 
-    ModuleData.Remove(GridCoord);
-    RebuildInstances();
-}
-
-void AF12InstancedRenderer::ClearAll()
-{
-    ModuleData.Empty();
-    InstanceToSourceMap.Empty();
-    
-    for (auto* HISM : HISMComponents)
+    TArray<int32>& Sources = InstanceSources[ComponentIndex];
+    const int32 LastIndex = HISM->GetInstanceCount() - 1;
+    if (InstanceIndex != LastIndex)
     {
-        if (HISM)
+        // Move the last instance into the freed slot
+        FTransform LastTransform;
+        HISM->GetInstanceTransform(LastIndex, LastTransform, true);
+        HISM->UpdateInstanceTransform(InstanceIndex, LastTransform, true, false, true);
+
+        // Custom data travels with the instance
+        const int32 NumFloats = HISM->NumCustomDataFloats;
+        for (int32 FloatIdx = 0; FloatIdx < NumFloats; FloatIdx++)
         {
-            HISM->ClearInstances();
+            HISM->SetCustomDataValue(InstanceIndex, FloatIdx, HISM->PerInstanceSMCustomData[LastIndex * NumFloats + FloatIdx], false);
+        }
+
+        // The moved tile (or merged module) takes over the freed index
+        const int32 MovedRef = Sources[LastIndex];
+        Sources[InstanceIndex] = MovedRef;
+        if (IsModuleComponent(ComponentIndex))
+        {
+            Modules.SetModuleInstanceIndex(MovedRef / FF12ModuleStore::NumTiles, InstanceIndex);
+        }
+        else
+        {
+            Modules.SetInstanceIndex(MovedRef / FF12ModuleStore::NumTiles, MovedRef % FF12ModuleStore::NumTiles, InstanceIndex);
         }
     }
+
+    Sources.Pop(EAllowShrinking::No);
+    HISM->RemoveInstance(LastIndex);
+    MarkTreeOutdated(ComponentIndex);
+}
+
+void AF12InstancedRenderer::ClearAll()
+{
+    Modules.Empty();
+    NumCulledFaces = 0;
+    BatchDirtySlots.Reset();
+    BatchRebuildChunks.Reset();
+    SnapshotPublisher.MarkCleared();
+
+    // Chunks and their components are recreated as modules are added again
+    DestroyChunks();
 }
 
 bool AF12InstancedRenderer::HasModule(FF12GridCoord GridCoord) const
 {
-    return ModuleData.Contains(GridCoord);
+    return Modules.Contains(GridCoord.ToIntVector());
 }
 
 // === TILE OPERATIONS ===
 
 void AF12InstancedRenderer::SetTileMaterial(FF12GridCoord GridCoord, int32 TileIndex, int32 MaterialIndex)
 {
-    if (!ModuleData.Contains(GridCoord) || TileIndex < 0 || TileIndex >= 12)
+    const int32 Slot = Modules.Find(GridCoord.ToIntVector());
+    if (Slot == INDEX_NONE || TileIndex < 0 || TileIndex >= 12)
         return;
 
-    int32 OldMatIdx = ModuleData[GridCoord].TileMaterials[TileIndex];
+    int32 OldMatIdx = Modules.GetMaterial(Slot, TileIndex);
     int32 NewMatIdx = FMath::Clamp(MaterialIndex, 0, NumMaterials - 1);
     
-    if (OldMatIdx == NewMatIdx)
+    if (OldMatIdx == NewMatIdx && !Modules.HasTileColor(Slot, TileIndex))
         return;  // No change needed
 
-    // Update data
-    ModuleData[GridCoord].TileMaterials[TileIndex] = NewMatIdx;
-    
-    // Only rebuild if tile is visible
-    if (ModuleData[GridCoord].TileVisibility[TileIndex])
-    {
-        RebuildInstances();
-    }
+    ApplyTileMaterial(Slot, TileIndex, NewMatIdx);
+    MarkCellChanged(GridCoord.ToIntVector());
 }
 
 void AF12InstancedRenderer::SetModuleMaterial(FF12GridCoord GridCoord, int32 MaterialIndex)
 {
-    if (!ModuleData.Contains(GridCoord))
+    const int32 Slot = Modules.Find(GridCoord.ToIntVector());
+    if (Slot == INDEX_NONE)
         return;
 
     MaterialIndex = FMath::Clamp(MaterialIndex, 0, NumMaterials - 1);
     
+    // Only tiles whose material changes move between components; the module is synced once at the end
+    FF12ScopedEditBatch Batch(this);
     bool bChanged = false;
     for (int32 i = 0; i < 12; i++)
     {
-        if (ModuleData[GridCoord].TileMaterials[i] != MaterialIndex)
+        if (Modules.GetMaterial(Slot, i) != MaterialIndex || Modules.HasTileColor(Slot, i))
         {
-            ModuleData[GridCoord].TileMaterials[i] = MaterialIndex;
+            ApplyTileMaterial(Slot, i, MaterialIndex);
             bChanged = true;
         }
     }
     
     if (bChanged)
     {
-        RebuildInstances();
+        MarkCellChanged(GridCoord.ToIntVector());
     }
 }
 
 void AF12InstancedRenderer::SetTileVisible(FF12GridCoord GridCoord, int32 TileIndex, bool bVisible)
 {
-    if (!ModuleData.Contains(GridCoord) || TileIndex < 0 || TileIndex >= 12)
+    const int32 Slot = Modules.Find(GridCoord.ToIntVector());
+    if (Slot == INDEX_NONE || TileIndex < 0 || TileIndex >= 12)
+        return;
+
+    if (Modules.IsVisible(Slot, TileIndex) == bVisible)
         return;
 
-    ModuleData[GridCoord].TileVisibility[TileIndex] = bVisible;
-    RebuildInstances();
+    if (MergedModuleMesh && !IsInEditBatch())
+    {
+        // Hiding a tile splits a merged module (showing the last one merges it); the commit syncs the module
+        FF12ScopedEditBatch Batch(this);
+        SetTileVisible(GridCoord, TileIndex, bVisible);
+        return;
+    }
+
+    Modules.SetVisible(Slot, TileIndex, bVisible);
+    if (IsInEditBatch())
+    {
+        MarkModuleDirty(Slot);
+    }
+    else if (bVisible)
+    {
+        if (IsTileRendered(Slot, TileIndex))
+        {
+            AddTileInstance(Slot, TileIndex);
+        }
+    }
+    else
+    {
+        RemoveTileInstanceOf(Slot, TileIndex);
+    }
+    MarkCellChanged(GridCoord.ToIntVector());
 }
 
 int32 AF12InstancedRenderer::GetTileMaterial(FF12GridCoord GridCoord, int32 TileIndex) const
 {
-    if (!ModuleData.Contains(GridCoord) || TileIndex < 0 || TileIndex >= 12)
+    const int32 Slot = Modules.Find(GridCoord.ToIntVector());
+    if (Slot == INDEX_NONE || TileIndex < 0 || TileIndex >= 12)
         return 0;
 
-    return ModuleData[GridCoord].TileMaterials[TileIndex];
+    return Modules.GetMaterial(Slot, TileIndex);
 }
 
 bool AF12InstancedRenderer::GetTileVisible(FF12GridCoord GridCoord, int32 TileIndex) const
 {
-    if (!ModuleData.Contains(GridCoord) || TileIndex < 0 || TileIndex >= 12)
+    const int32 Slot = Modules.Find(GridCoord.ToIntVector());
+    if (Slot == INDEX_NONE || TileIndex < 0 || TileIndex >= 12)
+        return false;
+
+    return Modules.IsVisible(Slot, TileIndex);
+}
+
+void AF12InstancedRenderer::SetTileColor(FF12GridCoord GridCoord, int32 TileIndex, FLinearColor Color, float Roughness)
+{
+    const int32 Slot = Modules.Find(GridCoord.ToIntVector());
+    if (Slot == INDEX_NONE || TileIndex < 0 || TileIndex >= 12)
+        return;
+
+    if (!UsesCustomData() && !bWarnedColorWithoutCustomData)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("SetTileColor: RenderMode is not CustomData, free colours are stored but tiles keep their palette material"));
+        bWarnedColorWithoutCustomData = true;
+    }
+
+    if (ApplyTileColor(Slot, TileIndex, F12TilePaint::Pack(Color, Roughness)))
+    {
+        MarkCellChanged(GridCoord.ToIntVector());
+    }
+}
+
+void AF12InstancedRenderer::SetModuleColor(FF12GridCoord GridCoord, FLinearColor Color, float Roughness)
+{
+    const int32 Slot = Modules.Find(GridCoord.ToIntVector());
+    if (Slot == INDEX_NONE)
+        return;
+
+    const uint32 PackedColor = F12TilePaint::Pack(Color, Roughness);
+    FF12ScopedEditBatch Batch(this);
+    bool bChanged = false;
+    for (int32 i = 0; i < 12; i++)
+    {
+        bChanged |= ApplyTileColor(Slot, i, PackedColor);
+    }
+
+    if (bChanged)
+    {
+        MarkCellChanged(GridCoord.ToIntVector());
+    }
+}
+
+bool AF12InstancedRenderer::GetTileColor(FF12GridCoord GridCoord, int32 TileIndex, FLinearColor& OutColor, float& OutRoughness) const
+{
+    const int32 Slot = Modules.Find(GridCoord.ToIntVector());
+    if (Slot == INDEX_NONE || TileIndex < 0 || TileIndex >= 12 || !Modules.HasTileColor(Slot, TileIndex))
         return false;
 
-    return ModuleData[GridCoord].TileVisibility[TileIndex];
+    const uint32 PackedColor = Modules.GetTileColor(Slot, TileIndex);
+    OutColor = F12TilePaint::UnpackColor(PackedColor);
+    OutRoughness = F12TilePaint::UnpackRoughness(PackedColor);
+    return true;
 }
 
 // === HIGHLIGHT SYSTEM ===
@@ -478,12 +1659,13 @@ void AF12InstancedRenderer::SetTileHighlight(FF12GridCoord GridCoord, int32 Tile
     bHasHighlight = false;
     HighlightedTileIndex = -1;
 
-    if (bHighlight && ModuleData.Contains(GridCoord))
+    const int32 Slot = Modules.Find(GridCoord.ToIntVector());
+    if (bHighlight && Slot != INDEX_NONE)
     {
         if (bSingleTile)
         {
             // Highlight just the one tile
-            if (TileIndex >= 0 && TileIndex < 12 && ModuleData[GridCoord].TileVisibility[TileIndex])
+            if (TileIndex >= 0 && TileIndex < 12 && Modules.IsVisible(Slot, TileIndex))
             {
                 FTransform TileTransform = GetTileWorldTransform(GridCoord, TileIndex);
                 TileTransform.SetScale3D(FVector(1.02f, 1.02f, 1.02f));
@@ -499,7 +1681,7 @@ void AF12InstancedRenderer::SetTileHighlight(FF12GridCoord GridCoord, int32 Tile
             // Add highlight instances for ALL 12 tiles of the module
             for (int32 i = 0; i < 12; i++)
             {
-                if (ModuleData[GridCoord].TileVisibility[i])
+                if (Modules.IsVisible(Slot, i))
                 {
                     FTransform TileTransform = GetTileWorldTransform(GridCoord, i);
                     TileTransform.SetScale3D(FVector(1.02f, 1.02f, 1.02f));
@@ -531,135 +1713,298 @@ void AF12InstancedRenderer::ClearAllHighlights()
 
 bool AF12InstancedRenderer::GetHitModuleAndTile(const FHitResult& Hit, FF12GridCoord& OutGridCoord, int32& OutTileIndex) const
 {
-    if (!GridSystem)
+    // Find which of our tile components was hit
+    const int32* HitComponentIdx = ComponentLookup.Find((uint64)(UPTRINT)Hit.GetComponent());
+    if (!HitComponentIdx)
         return false;
 
-    // Check if we hit one of our HISM components
-    UHierarchicalInstancedStaticMeshComponent* HitHISM = Cast<UHierarchicalInstancedStaticMeshComponent>(Hit.GetComponent());
-    if (!HitHISM)
+    // Hit.Item contains the instance index for instanced static meshes
+    const TArray<int32>& Sources = InstanceSources[*HitComponentIdx];
+    if (!Sources.IsValidIndex(Hit.Item))
         return false;
 
-    // Find which component was hit
-    int32 HitComponentIdx = HISMComponents.Find(HitHISM);
-    if (HitComponentIdx == INDEX_NONE)
+    const int32 TileRef = Sources[Hit.Item];
+    const int32 Slot = TileRef / FF12ModuleStore::NumTiles;
+    int32 TileIndex = TileRef % FF12ModuleStore::NumTiles;
+    const bool bMergedHit = IsModuleComponent(*HitComponentIdx);
+
+    // A chunk waiting for its rebuild may still show instances of removed modules
+    if (IsChunkRebuildPending(*HitComponentIdx / ComponentsPerChunk)
+        && (Modules.Find(Modules.GetCell(Slot)) != Slot
+            || (bMergedHit ? Modules.GetModuleInstanceIndex(Slot) : Modules.GetInstanceIndex(Slot, TileIndex)) != Hit.Item))
+    {
         return false;
+    }
 
-    // Get the instance index from the hit result
-    // Hit.Item contains the instance index for instanced static meshes
-    int32 HitInstanceIdx = Hit.Item;
-    
-    // Look up the source module and tile from our tracking map
-    FF12InstanceKey Key(HitComponentIdx, HitInstanceIdx);
-    const FF12InstanceSourceData* SourceData = InstanceToSourceMap.Find(Key);
-    
-    if (SourceData)
+    OutGridCoord = FF12GridCoord(Modules.GetCell(Slot));
+
+    // A merged module is one instance: the tile is the face pointing at the hit
+    if (bMergedHit)
     {
-        // Found exact match in our tracking map
-        OutGridCoord = SourceData->GridCoord;
-        OutTileIndex = SourceData->TileIndex;
-        return true;
+        if (!ResolveGridSystem())
+            return false;
+        TileIndex = F12Lattice::GetFaceForDirection(Hit.Location - GridSystem->GridToWorld(OutGridCoord));
     }
-    
-    // Fallback: If instance tracking failed (shouldn't happen normally),
-    // use the old nearest-module approach
-    UE_LOG(LogTemp, Warning, TEXT("GetHitModuleAndTile: Instance not found in tracking map (Comp=%d, Inst=%d), using fallback"), 
-        HitComponentIdx, HitInstanceIdx);
-    
-    // Decode face index from component index as fallback
-    OutTileIndex = HitComponentIdx / NumMaterials;
-    
-    // Get world position of hit and convert to grid coordinate
-    FVector HitLocation = Hit.ImpactPoint;
-    
-    // Find the nearest module to this hit point
-    float NearestDistSq = FLT_MAX;
-    FF12GridCoord NearestCoord;
-    bool bFound = false;
-    
-    for (const auto& Pair : ModuleData)
+
+    OutTileIndex = TileIndex;
+    return true;
+}
+
+// === REBUILD ===
+
+void AF12InstancedRenderer::RebuildInstances()
+{
+    // Safety check - ensure the renderer is initialized
+    if (FaceTransforms.Num() == 0)
     {
-        FVector ModulePos = GridSystem->GridToWorld(Pair.Key);
-        float DistSq = FVector::DistSquared(HitLocation, ModulePos);
-        
-        if (DistSq < NearestDistSq)
-        {
-            NearestDistSq = DistSq;
-            NearestCoord = Pair.Key;
-            bFound = true;
-        }
+        UE_LOG(LogTemp, Warning, TEXT("RebuildInstances called but the renderer is not initialized"));
+        return;
     }
-    
-    if (bFound)
+
+    const double StartTime = FPlatformTime::Seconds();
+
+    TArray<int32> AllChunks;
+    AllChunks.SetNumUninitialized(Chunks.Num());
+    for (int32 ChunkIdx = 0; ChunkIdx < Chunks.Num(); ChunkIdx++)
     {
-        OutGridCoord = NearestCoord;
-        return true;
+        AllChunks[ChunkIdx] = ChunkIdx;
+
+        // Settings such as bCullInteriorFaces may have changed: bake again
+        MarkChunkEdited(ChunkIdx);
+    }
+    RebuildOrQueueChunks(AllChunks);
+
+    if (bTimeSliceRebuilds)
+    {
+        UE_LOG(LogTemp, Log, TEXT("RebuildInstances: %d modules, %d chunks queued"), Modules.Num(), QueuedChunks.Num());
+        return;
     }
     
-    return false;
+    UE_LOG(LogTemp, Log, TEXT("RebuildInstances: %d modules in %d chunks, %d instances tracked, %.2f ms"), 
+        Modules.Num(), Chunks.Num(), GetTotalInstanceCount(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
 }
 
-// === REBUILD ===
+void AF12InstancedRenderer::RebuildOrQueueChunks(const TArray<int32>& ChunkIndices)
+{
+    if (!bTimeSliceRebuilds)
+    {
+        RebuildChunks(ChunkIndices);
+        return;
+    }
 
-void AF12InstancedRenderer::RebuildInstances()
+    // From here on the chunks' instances are left alone until ProcessRebuildQueue gets to them
+    for (const int32 ChunkIdx : ChunkIndices)
+    {
+        QueuedChunks.FindOrAdd((uint64)ChunkIdx);
+    }
+}
+
+void AF12InstancedRenderer::FlushQueuedRebuilds()
 {
-    // Safety check - ensure components are initialized
-    if (HISMComponents.Num() == 0)
+    TArray<int32> Queued;
+    Queued.Reserve(QueuedChunks.Num());
+    QueuedChunks.ForEach([&Queued](uint64 ChunkKey, uint8)
     {
-        UE_LOG(LogTemp, Warning, TEXT("RebuildInstances called but HISMComponents not initialized"));
+        Queued.Add((int32)ChunkKey);
+    });
+    RebuildChunks(Queued);
+}
+
+void AF12InstancedRenderer::ProcessRebuildQueue()
+{
+    if (!ResolveGridSystem())
         return;
+
+    // Order the queue by distance from the camera to the chunk centers
+    struct FQueuedChunk
+    {
+        int32 ChunkIndex;
+        double DistSq;
+    };
+    TArray<FQueuedChunk> Queue;
+    Queue.Reserve(QueuedChunks.Num());
+
+    FVector ViewLocation;
+    const bool bHasView = GetViewLocation(ViewLocation);
+    const double ChunkWorldSize = (double)(1 << ChunkShift) * GridSystem->GetAdjustedSpacing();
+    QueuedChunks.ForEach([&](uint64 ChunkKey, uint8)
+    {
+        const FIntVector& Coord = Chunks[(int32)ChunkKey].Coord;
+        const FVector Center = (FVector(Coord) + FVector(0.5)) * ChunkWorldSize;
+        Queue.Add({ (int32)ChunkKey, bHasView ? FVector::DistSquared(Center, ViewLocation) : 0.0 });
+    });
+    Queue.Sort([](const FQueuedChunk& A, const FQueuedChunk& B) { return A.DistSq < B.DistSq; });
+
+    // Take chunks until their estimated cost fills the budget
+    TArray<int32> Slice;
+    int32 SliceModules = 0;
+    double EstimatedMs = 0.0;
+    for (const FQueuedChunk& Entry : Queue)
+    {
+        const int32 NumChunkModules = Chunks[Entry.ChunkIndex].Slots.Num();
+        const double CostMs = RebuildMsPerModule * FMath::Max(NumChunkModules, 1);
+        if (Slice.Num() > 0 && EstimatedMs + CostMs > RebuildBudgetMs)
+            break;
+
+        Slice.Add(Entry.ChunkIndex);
+        SliceModules += NumChunkModules;
+        EstimatedMs += CostMs;
     }
-    
-    // Clear all instances and tracking map
-    for (auto* HISM : HISMComponents)
+
+    const double StartTime = FPlatformTime::Seconds();
+    RebuildChunks(Slice);
+    const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+    // Follow the measured cost so the next slices fit the budget
+    RebuildMsPerModule = FMath::Lerp(RebuildMsPerModule, ElapsedMs / FMath::Max(SliceModules, 1), 0.5);
+
+    if (QueuedChunks.Num() == 0)
+    {
+        UE_LOG(LogTemp, Log, TEXT("Time-sliced rebuild finished: %d modules, %d instances"), Modules.Num(), GetTotalInstanceCount());
+    }
+}
+
+bool AF12InstancedRenderer::GetViewLocation(FVector& OutLocation) const
+{
+    APlayerController* PlayerController = GetWorld() ? GetWorld()->GetFirstPlayerController() : nullptr;
+    if (!PlayerController)
+        return false;
+
+    FRotator ViewRotation;
+    PlayerController->GetPlayerViewPoint(OutLocation, ViewRotation);
+    return true;
+}
+
+void AF12InstancedRenderer::RebuildChunks(const TArray<int32>& ChunkIndices)
+{
+    if (ChunkIndices.Num() == 0 || !ResolveGridSystem())
+        return;
+
+    // A rebuild now supersedes a queued one
+    for (const int32 ChunkIdx : ChunkIndices)
     {
-        if (HISM && HISM->IsRegistered())
+        QueuedChunks.Remove((uint64)ChunkIdx);
+    }
+
+    const double Spacing = GridSystem->GetAdjustedSpacing();
+    const EParallelForFlags Flags = CVarF12ParallelRebuild.GetValueOnGameThread() ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread;
+
+    // Build in waves so the transform arrays of a huge rebuild are never all alive at once
+    TArray<FF12ChunkInstanceBatch> Batches;
+    for (int32 WaveStart = 0; WaveStart < ChunkIndices.Num(); WaveStart += RebuildWaveSize)
+    {
+        const int32 WaveNum = FMath::Min(RebuildWaveSize, ChunkIndices.Num() - WaveStart);
+        Batches.Reset();
+        Batches.SetNum(WaveNum);
+
+        ParallelFor(WaveNum, [this, &ChunkIndices, &Batches, WaveStart, Spacing](int32 Index)
+        {
+            BuildChunkInstances(ChunkIndices[WaveStart + Index], Spacing, Batches[Index]);
+        }, Flags);
+
+        // Component calls stay on the game thread
+        for (int32 Index = 0; Index < WaveNum; Index++)
         {
-            HISM->ClearInstances();
+            SubmitChunkInstances(ChunkIndices[WaveStart + Index], Batches[Index]);
         }
     }
-    
-    // Clear the instance tracking map - will be rebuilt
-    InstanceToSourceMap.Empty();
+}
 
-    // Rebuild from module data (batch add without immediate updates)
-    for (const auto& Pair : ModuleData)
+void AF12InstancedRenderer::BuildChunkInstances(int32 ChunkIndex, double Spacing, FF12ChunkInstanceBatch& OutBatch)
+{
+    OutBatch.Transforms.SetNum(ComponentsPerChunk);
+    OutBatch.Sources.SetNum(ComponentsPerChunk);
+    if (UsesCustomData())
     {
-        const FF12GridCoord& Coord = Pair.Key;
-        const FF12ModuleInstanceData& Data = Pair.Value;
-        
-        for (int32 TileIdx = 0; TileIdx < 12; TileIdx++)
+        OutBatch.CustomData.SetNum(ComponentsPerChunk);
+    }
+
+    for (const int32 Slot : Chunks[ChunkIndex].Slots)
+    {
+        const FIntVector& Cell = Modules.GetCell(Slot);
+        const FVector ModulePos(Cell.X * Spacing, Cell.Y * Spacing, Cell.Z * Spacing);
+
+        // Uniform module: one merged instance and no tile instances
+        if (WantsMergedInstance(Slot))
+        {
+            const int32 LocalIdx = GetModuleComponentIndex(0, Modules.GetMaterial(Slot, 0));
+            Modules.SetModuleInstanceIndex(Slot, OutBatch.Transforms[LocalIdx].Num());
+            OutBatch.Transforms[LocalIdx].Add(FTransform(ModulePos));
+            OutBatch.Sources[LocalIdx].Add(Slot * FF12ModuleStore::NumTiles);
+
+            if (UsesCustomData())
+            {
+                TArray<float>& CustomData = OutBatch.CustomData[LocalIdx];
+                const int32 Offset = CustomData.AddUninitialized(NumTileCustomData);
+                GetTileCustomData(Slot, 0, CustomData.GetData() + Offset);
+            }
+
+            for (int32 TileIdx = 0; TileIdx < F12Lattice::NumFaces; TileIdx++)
+            {
+                Modules.SetInstanceIndex(Slot, TileIdx, INDEX_NONE);
+            }
+            continue;
+        }
+        Modules.SetModuleInstanceIndex(Slot, INDEX_NONE);
+
+        for (int32 TileIdx = 0; TileIdx < F12Lattice::NumFaces; TileIdx++)
         {
-            if (Data.TileVisibility[TileIdx])
+            if (!IsTileRendered(Slot, TileIdx))
             {
-                int32 MatIdx = Data.TileMaterials[TileIdx];
-                int32 ComponentIdx = TileIdx * NumMaterials + FMath::Clamp(MatIdx, 0, NumMaterials - 1);
-                
-                UHierarchicalInstancedStaticMeshComponent* HISM = GetHISMForFaceAndMaterial(TileIdx, MatIdx);
-                
-                if (HISM && HISM->IsRegistered())
-                {
-                    FTransform TileTransform = GetTileWorldTransform(Coord, TileIdx);
-                    int32 InstanceIdx = HISM->AddInstance(TileTransform, false);  // Don't update immediately
-                    
-                    // Track this instance -> source mapping
-                    FF12InstanceKey Key(ComponentIdx, InstanceIdx);
-                    InstanceToSourceMap.Add(Key, FF12InstanceSourceData(Coord, TileIdx));
-                }
+                Modules.SetInstanceIndex(Slot, TileIdx, INDEX_NONE);
+                continue;
+            }
+
+            // Chunk 0 gives the local component index
+            const int32 LocalIdx = GetComponentIndex(0, TileIdx, Modules.GetMaterial(Slot, TileIdx));
+            TArray<FTransform>& Transforms = OutBatch.Transforms[LocalIdx];
+
+            // The component is cleared before submission, so instances land at these indices
+            Modules.SetInstanceIndex(Slot, TileIdx, Transforms.Num());
+            Transforms.Add_GetRef(FaceTransforms[TileIdx]).AddToTranslation(ModulePos);
+            OutBatch.Sources[LocalIdx].Add(Slot * FF12ModuleStore::NumTiles + TileIdx);
+
+            if (UsesCustomData())
+            {
+                TArray<float>& CustomData = OutBatch.CustomData[LocalIdx];
+                const int32 Offset = CustomData.AddUninitialized(NumTileCustomData);
+                GetTileCustomData(Slot, TileIdx, CustomData.GetData() + Offset);
             }
         }
     }
-    
-    // Mark all components dirty after batch add
-    for (auto* HISM : HISMComponents)
+}
+
+void AF12InstancedRenderer::SubmitChunkInstances(int32 ChunkIndex, FF12ChunkInstanceBatch& Batch)
+{
+    const int32 FirstComponent = ChunkIndex * ComponentsPerChunk;
+    for (int32 LocalIdx = 0; LocalIdx < ComponentsPerChunk; LocalIdx++)
     {
-        if (HISM && HISM->IsRegistered() && HISM->GetInstanceCount() > 0)
+        const int32 ComponentIdx = FirstComponent + LocalIdx;
+        const TArray<FTransform>& Transforms = Batch.Transforms[LocalIdx];
+
+        UHierarchicalInstancedStaticMeshComponent* HISM = Transforms.Num() > 0 ? GetOrCreateComponent(ComponentIdx) : HISMComponents[ComponentIdx];
+        InstanceSources[ComponentIdx] = MoveTemp(Batch.Sources[LocalIdx]);
+        if (!HISM)
+            continue;
+
+        HISM->ClearInstances();
+        MarkTreeOutdated(ComponentIdx);
+        if (Transforms.Num() == 0)
+            continue;
+
+        // One call, one cluster tree build for the whole component
+        HISM->AddInstances(Transforms, false);
+
+        if (UsesCustomData())
         {
+            const TArray<float>& CustomData = Batch.CustomData[LocalIdx];
+            for (int32 InstanceIdx = 0; InstanceIdx < Transforms.Num(); InstanceIdx++)
+            {
+                HISM->SetCustomData(InstanceIdx, MakeArrayView(CustomData.GetData() + InstanceIdx * NumTileCustomData, NumTileCustomData), false);
+            }
             HISM->MarkRenderStateDirty();
         }
     }
-    
-    UE_LOG(LogTemp, Log, TEXT("RebuildInstances: %d modules, %d instances tracked"), 
-        ModuleData.Num(), InstanceToSourceMap.Num());
 }
 
 // === STATISTICS ===
@@ -679,22 +2024,36 @@ int32 AF12InstancedRenderer::GetTotalInstanceCount() const
 
 FString AF12InstancedRenderer::GetPerformanceStats() const
 {
-    int32 ModuleCount = ModuleData.Num();
+    int32 ModuleCount = Modules.Num();
     int32 InstanceCount = GetTotalInstanceCount();
+    int32 MergedCount = 0;
     int32 DrawCalls = 0;
 
-    for (const auto* HISM : HISMComponents)
+    for (int32 ComponentIdx = 0; ComponentIdx < HISMComponents.Num(); ComponentIdx++)
     {
+        const UHierarchicalInstancedStaticMeshComponent* HISM = HISMComponents[ComponentIdx];
         if (HISM && HISM->GetInstanceCount() > 0)
         {
             DrawCalls++;
+            if (IsModuleComponent(ComponentIdx))
+            {
+                MergedCount += HISM->GetInstanceCount();
+            }
         }
     }
 
     return FString::Printf(
-        TEXT("Modules: %d | Tiles: %d | Draw Calls: %d"),
+        TEXT("Modules: %d (%d merged) | Instances: %d | Culled: %d | Chunks: %d (%d HLOD, %d proxy) | Draw Calls: %d | Trees: %d building, last %.1f ms (%d)"),
         ModuleCount,
+        MergedCount,
         InstanceCount,
-        DrawCalls
+        bCullInteriorFaces ? NumCulledFaces : 0,
+        Chunks.Num(),
+        NumHLODChunks,
+        NumProxyChunks,
+        DrawCalls,
+        PendingTreeBuilds.Num(),
+        LastTreeBuildLatencyMs,
+        LastTreeBuildComponents
     );
 }
\ No newline at end of file
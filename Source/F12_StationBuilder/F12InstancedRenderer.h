@@ -7,82 +7,94 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "F12GridSystem.h"
+#include "F12FlatMap.h"
+#include "F12StationSnapshot.h"
+#include "F12ModuleStore.h"
+#include "F12ChunkBaker.h"
+#include "Async/Future.h"
 #include "F12InstancedRenderer.generated.h"
 
 class UHierarchicalInstancedStaticMeshComponent;
+class UProceduralMeshComponent;
 class UStaticMesh;
 
-// Data stored per module
-USTRUCT()
-struct FF12ModuleInstanceData
+// How tile materials reach the GPU
+UENUM(BlueprintType)
+enum class EF12TileRenderMode : uint8
 {
-    GENERATED_BODY()
-
-    // Material index for each of the 12 tiles (0-based index into TileMaterials array)
-    UPROPERTY()
-    TArray<int32> TileMaterials;
-
-    // Visibility for each tile
-    UPROPERTY()
-    TArray<bool> TileVisibility;
+    // One HISM per face x material; repainting moves instances between components
+    PerMaterialComponents,
 
-    FF12ModuleInstanceData()
-    {
-        TileMaterials.SetNum(12);
-        TileVisibility.SetNum(12);
-        for (int32 i = 0; i < 12; i++)
-        {
-            TileMaterials[i] = 0;
-            TileVisibility[i] = true;
-        }
-    }
+    // One HISM for all tiles; paint is per-instance custom data read by TileMasterMaterial
+    // (the only mode that can show free tile colours, see SetTileColor)
+    CustomData
 };
 
-// Key for instance lookup: combines HISM component index with instance index
+// One spatial chunk of the renderer: a cube of lattice cells with its own tile components
 USTRUCT()
-struct FF12InstanceKey
+struct FF12RenderChunk
 {
     GENERATED_BODY()
 
+    // Cell coordinate >> chunk shift
+    FIntVector Coord = FIntVector::ZeroValue;
+
+    // Slots of the modules in this chunk (unordered)
+    TArray<int32> Slots;
+
+    // Mesh of this chunk's tile components (nullptr = TileStaticMesh)
     UPROPERTY()
-    int32 ComponentIndex = 0;
+    UStaticMesh* TileMesh = nullptr;
 
+    bool bHidden = false;
+
+    // Baked mesh of the chunk's visible faces, drawn instead of the instances when far away
+    // (created by the first bake)
     UPROPERTY()
-    int32 InstanceIndex = 0;
+    UProceduralMeshComponent* HLODMesh = nullptr;
 
-    FF12InstanceKey() {}
-    FF12InstanceKey(int32 InComp, int32 InInst) : ComponentIndex(InComp), InstanceIndex(InInst) {}
+    // Bumped by every edit in or next to the chunk; the baked mesh is current while HLODVersion == EditVersion
+    uint32 EditVersion = 1;
+    uint32 HLODVersion = 0;
 
-    bool operator==(const FF12InstanceKey& Other) const
-    {
-        return ComponentIndex == Other.ComponentIndex && InstanceIndex == Other.InstanceIndex;
-    }
+    bool bHLODBaking = false;
+    bool bShowingHLOD = false;
 
-    friend uint32 GetTypeHash(const FF12InstanceKey& Key)
-    {
-        return HashCombine(GetTypeHash(Key.ComponentIndex), GetTypeHash(Key.InstanceIndex));
-    }
+    // One coarse proxy instance per occupied block, drawn instead of everything else when the
+    // chunk is tiny on screen (created by the first proxy build)
+    UPROPERTY()
+    UHierarchicalInstancedStaticMeshComponent* ProxyHISM = nullptr;
+
+    // EditVersion the proxies were built from
+    uint32 ProxyVersion = 0;
+
+    bool bShowingProxy = false;
+
+    // Are the tile (and merged module) instances drawn? Proxies win over the baked mesh, which wins over instances.
+    bool DrawsInstances() const { return !bHidden && !bShowingProxy && !bShowingHLOD; }
 };
 
-// Data mapping an instance back to its source module and tile
-USTRUCT()
-struct FF12InstanceSourceData
+// Instances of one chunk built off the game thread, grouped by the chunk's local component index
+struct FF12ChunkInstanceBatch
 {
-    GENERATED_BODY()
+    TArray<TArray<FTransform>> Transforms;
 
-    UPROPERTY()
-    FF12GridCoord GridCoord;
-
-    UPROPERTY()
-    int32 TileIndex = 0;
+    // Tile reference (Slot * NumTiles + Tile) of each transform, same order
+    TArray<TArray<int32>> Sources;
 
-    FF12InstanceSourceData() {}
-    FF12InstanceSourceData(FF12GridCoord InCoord, int32 InTile) : GridCoord(InCoord), TileIndex(InTile) {}
+    // CustomData mode: NumTileCustomData floats per transform
+    TArray<TArray<float>> CustomData;
 };
 
 /**
  * Renders F12 modules using GPU instancing for maximum performance.
  * Each module's 12 tiles are rendered as instances of a static mesh.
+ *
+ * Modules are grouped into cubic chunks of ChunkSize cells per axis. Each chunk owns its
+ * own tile components (created on first use), so an edit only touches the components and
+ * cluster trees of its chunk, and a chunk can be culled, hidden or given another mesh alone.
+ * Distant chunks can swap their instances for one baked mesh (see bChunkHLODs), and chunks
+ * that are tiny on screen for a handful of coarse proxies (see bFarFieldProxies).
  */
 UCLASS()
 class AF12InstancedRenderer : public AActor
@@ -94,6 +106,11 @@ public:
 
     virtual void BeginPlay() override;
 
+    // Publishes a station snapshot when modules or tiles changed this frame and
+    // starts/finishes the cluster tree builds of components whose instances changed,
+    // then swaps far chunks to their baked meshes or proxies and starts the bakes they need
+    virtual void Tick(float DeltaSeconds) override;
+
     // === CONFIGURATION ===
 
     // The static mesh to use for tiles (import from Blender)
@@ -101,28 +118,133 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "F12|Mesh")
     UStaticMesh* TileStaticMesh;
 
+    // Optional: all 12 tiles merged into one mesh (module pivot, tiles in their face positions).
+    // Uniform modules (one material, every tile visible, no free colours) are drawn as one instance
+    // of it and split back into tile instances when a tile is repainted, coloured or hidden, or when
+    // neighbors cover more than MaxMergedCulledFaces of its faces.
+    // Read when the components are laid out (BeginPlay); nullptr = tile instances only.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "F12|Mesh")
+    UStaticMesh* MergedModuleMesh;
+
     // Materials for each tile type (index 0 = default, 1-N = paint materials)
+    // In CustomData mode only the count matters: it is the size of the paint palette
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "F12|Materials")
     TArray<UMaterialInterface*> TileMaterials;
 
+    // Component layout for tiles (read at BeginPlay)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "F12|Rendering")
+    EF12TileRenderMode RenderMode = EF12TileRenderMode::PerMaterialComponents;
+
+    // CustomData mode: single material that reads the tile's paint from per-instance custom data:
+    //   [0] palette material index
+    //   [1..3] linear RGB of the free colour
+    //   [4] roughness of the free colour, or -1 if the tile uses its palette entry
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "F12|Materials")
+    UMaterialInterface* TileMasterMaterial;
+
     // Module geometry settings (must match your static mesh and grid system)
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "F12|Geometry")
     float ModuleSize = 600.0f;
 
+    // Give tile HISMs physics collision. Picking uses the grid raycast, so this is
+    // only needed when other gameplay traces must hit the station.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "F12|Collision")
+    bool bEnableTileCollision = false;
+
+    // Skip instances for faces shared by two modules (they can never be seen)
+    // Changing this at runtime takes effect on the next full rebuild
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "F12|Rendering")
+    bool bCullInteriorFaces = true;
+
+    // Cells per chunk axis, rounded up to a power of two (read at BeginPlay)
+    // Smaller chunks make edits cheaper but add components and draw calls
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "F12|Rendering", meta = (ClampMin = "1", ClampMax = "256"))
+    int32 ChunkSize = 16;
+
+    // Build HISM cluster trees on worker threads, once per frame for all edits to a component.
+    // A component keeps drawing its previous tree (plus its not yet built instances) until the
+    // new tree is ready. Set before play (components already created keep their setting).
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "F12|Rendering")
+    bool bAsyncTreeBuilds = true;
+
+    // Spread chunk rebuilds (full rebuilds, large bulk adds and removals) over several frames,
+    // nearest chunks to the camera first. A queued chunk keeps showing its old instances until it is rebuilt.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "F12|Rendering")
+    bool bTimeSliceRebuilds = false;
+
+    // Game-thread time per frame for queued chunk rebuilds (at least one chunk is rebuilt per frame)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "F12|Rendering", meta = (ClampMin = "0.1", EditCondition = "bTimeSliceRebuilds"))
+    float RebuildBudgetMs = 4.0f;
+
+    // Chunks farther than this from the camera are not drawn at all (0 = no limit)
+    // Change it at runtime with SetChunkCullDistance, which updates the existing components
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "F12|Rendering", meta = (ClampMin = "0"))
+    float ChunkCullDistance = 0.0f;
+
+    // Draw distant chunks as one baked mesh of their visible faces instead of tile instances (one section
+    // per material, or one drawn with HLODMaterial in CustomData mode). Meshes are baked on worker threads
+    // from the station snapshot and rebaked after edits; until a chunk's bake is current it keeps drawing
+    // its instances.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "F12|HLOD")
+    bool bChunkHLODs = true;
+
+    // CustomData mode: material of the baked meshes, which have no per-instance custom data. It reads
+    // the same paint layout as TileMasterMaterial from TexCoord 1 ([0] in U, [4] in V) and the vertex
+    // colour ([1..3]). Without it there are no HLODs in CustomData mode (per-material mode uses TileMaterials).
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "F12|HLOD", meta = (EditCondition = "bChunkHLODs"))
+    UMaterialInterface* HLODMaterial;
+
+    // Chunks whose nearest point is farther than this from the camera switch to their baked mesh
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "F12|HLOD", meta = (ClampMin = "0", EditCondition = "bChunkHLODs"))
+    float HLODDistance = 20000.0f;
+
+    // A chunk switches back to instances only once it is this much closer than HLODDistance
+    // (bakes also start in this band, so the mesh is ready when the chunk crosses HLODDistance)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "F12|HLOD", meta = (ClampMin = "0", EditCondition = "bChunkHLODs"))
+    float HLODHysteresis = 2000.0f;
+
+    // Bakes running on worker threads at the same time
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "F12|HLOD", meta = (ClampMin = "1", EditCondition = "bChunkHLODs"))
+    int32 MaxConcurrentHLODBakes = 4;
+
+    // Draw chunks that cover less than ProxyScreenSize of the screen as coarse proxies: one instance of
+    // ProxyMesh stretched over the occupied cells of each occupancy brick (8^3 cells) in the chunk.
+    // Proxies are built from the grid occupancy on the game thread (a few instances per chunk).
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "F12|HLOD")
+    bool bFarFieldProxies = true;
+
+    // Low-poly proxy mesh, pivot at its bounds center (nullptr = MergedModuleMesh; no mesh = no proxies)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "F12|HLOD", meta = (EditCondition = "bFarFieldProxies"))
+    UStaticMesh* ProxyMesh;
+
+    // Material of the proxies (nullptr = first tile material)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "F12|HLOD", meta = (EditCondition = "bFarFieldProxies"))
+    UMaterialInterface* ProxyMaterial;
+
+    // Screen size (bounding sphere diameter / screen height) below which a chunk switches to proxies.
+    // It switches back above ProxyScreenSize * ProxyScreenSizeHysteresis.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "F12|HLOD", meta = (ClampMin = "0", ClampMax = "1", EditCondition = "bFarFieldProxies"))
+    float ProxyScreenSize = 0.15f;
+
     // === MODULE MANAGEMENT ===
 
     // Add a module at the given grid coordinate
     UFUNCTION(BlueprintCallable, Category = "F12|Modules")
     void AddModule(FF12GridCoord GridCoord, int32 MaterialIndex = 0);
 
-    // Add multiple modules at once (more efficient than individual adds)
+    // Add multiple modules at once (one edit batch)
     UFUNCTION(BlueprintCallable, Category = "F12|Modules")
     void AddModulesBulk(const TArray<FF12GridCoord>& GridCoords, int32 MaterialIndex = 0);
 
-    // Remove a module
+    // Remove a module (only its own instances are touched)
     UFUNCTION(BlueprintCallable, Category = "F12|Modules")
     void RemoveModule(FF12GridCoord GridCoord);
 
+    // Remove multiple modules at once (one edit batch)
+    // Chunks losing a small share of their modules remove instances one by one; the others are rebuilt
+    UFUNCTION(BlueprintCallable, Category = "F12|Modules")
+    void RemoveModulesBulk(const TArray<FF12GridCoord>& GridCoords);
+
     // Clear all modules
     UFUNCTION(BlueprintCallable, Category = "F12|Modules")
     void ClearAll();
@@ -131,6 +253,68 @@ public:
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "F12|Modules")
     bool HasModule(FF12GridCoord GridCoord) const;
 
+    // Rebuild every instance from the module data (e.g. after changing bCullInteriorFaces)
+    // With bTimeSliceRebuilds the chunks are queued instead
+    UFUNCTION(BlueprintCallable, Category = "F12|Modules")
+    void RebuildInstances();
+
+    // Rebuild every queued chunk now
+    UFUNCTION(BlueprintCallable, Category = "F12|Modules")
+    void FlushQueuedRebuilds();
+
+    // Chunks waiting for a time-sliced rebuild
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "F12|Modules")
+    int32 GetQueuedChunkCount() const { return QueuedChunks.Num(); }
+
+    // === EDIT BATCHES ===
+
+    // Start collecting edits: adds, removes, paints and visibility changes update the module data
+    // right away, but instances are only brought up to date by the matching EndEditBatch.
+    // Batches nest; only the outermost EndEditBatch commits. Prefer FF12ScopedEditBatch in C++.
+    // Hit lookups (GetHitModuleAndTile) may be stale until the batch is committed.
+    UFUNCTION(BlueprintCallable, Category = "F12|Modules")
+    void BeginEditBatch();
+
+    // Commit the batch: chunks with a large share of changed modules are rebuilt, in the
+    // others only the changed modules' instances are added, removed or rewritten
+    UFUNCTION(BlueprintCallable, Category = "F12|Modules")
+    void EndEditBatch();
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "F12|Modules")
+    bool IsInEditBatch() const { return EditBatchDepth > 0; }
+
+    // === CHUNKS ===
+
+    // Chunk containing a grid cell
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "F12|Chunks")
+    FIntVector GetChunkCoord(FF12GridCoord GridCoord) const;
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "F12|Chunks")
+    int32 GetChunkCount() const { return Chunks.Num(); }
+
+    // Hide or show every tile of a chunk (e.g. while a stand-in is drawn instead)
+    UFUNCTION(BlueprintCallable, Category = "F12|Chunks")
+    void SetChunkHidden(FIntVector ChunkCoord, bool bHidden);
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "F12|Chunks")
+    bool IsChunkHidden(FIntVector ChunkCoord) const;
+
+    // Draw a chunk's tiles with another mesh, e.g. a lower-detail one (nullptr = TileStaticMesh)
+    UFUNCTION(BlueprintCallable, Category = "F12|Chunks")
+    void SetChunkTileMesh(FIntVector ChunkCoord, UStaticMesh* Mesh);
+
+    // Set ChunkCullDistance and apply it to every chunk's tile, baked and proxy components
+    UFUNCTION(BlueprintCallable, Category = "F12|Chunks")
+    void SetChunkCullDistance(float Distance);
+
+    // Chunks currently drawn as their baked mesh
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "F12|Chunks")
+    int32 GetHLODChunkCount() const { return NumHLODChunks; }
+
+    // Chunks currently drawn as coarse proxies
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "F12|Chunks")
+    int32 GetProxyChunkCount() const { return NumProxyChunks; }
+
     // === TILE OPERATIONS ===
 
     // Set material for a specific tile
@@ -153,6 +337,19 @@ public:
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "F12|Tiles")
     bool GetTileVisible(FF12GridCoord GridCoord, int32 TileIndex) const;
 
+    // Paint a tile with any colour (stored as 8-bit sRGB + 8-bit roughness)
+    // Rendered in CustomData mode only; SetTileMaterial/SetModuleMaterial go back to the palette
+    UFUNCTION(BlueprintCallable, Category = "F12|Tiles")
+    void SetTileColor(FF12GridCoord GridCoord, int32 TileIndex, FLinearColor Color, float Roughness = 0.5f);
+
+    // Paint all tiles in a module with any colour
+    UFUNCTION(BlueprintCallable, Category = "F12|Tiles")
+    void SetModuleColor(FF12GridCoord GridCoord, FLinearColor Color, float Roughness = 0.5f);
+
+    // Free colour of a tile; returns false if the tile uses its palette material
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "F12|Tiles")
+    bool GetTileColor(FF12GridCoord GridCoord, int32 TileIndex, FLinearColor& OutColor, float& OutRoughness) const;
+
     // === HIGHLIGHT SYSTEM ===
 
     // Highlight material for delete mode hover
@@ -177,7 +374,10 @@ public:
     // === STATISTICS ===
 
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "F12|Stats")
-    int32 GetModuleCount() const { return ModuleData.Num(); }
+    int32 GetModuleCount() const { return Modules.Num(); }
+
+    // Bytes held by the per-module tile records
+    SIZE_T GetModuleDataSize() const { return Modules.GetAllocatedSize(); }
 
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "F12|Stats")
     int32 GetTotalInstanceCount() const;
@@ -185,15 +385,52 @@ public:
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "F12|Stats")
     FString GetPerformanceStats() const;
 
+    // Components whose cluster tree is waiting for or running an async build
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "F12|Stats")
+    int32 GetPendingTreeBuildCount() const { return PendingTreeBuilds.Num(); }
+
+    // Time from the first instance change to the last tree being ready, for the most recent
+    // round of tree builds (a rebuild, a bulk edit or a frame of single edits)
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "F12|Stats")
+    float GetLastTreeBuildLatencyMs() const { return (float)LastTreeBuildLatencyMs; }
+
+    // === SNAPSHOTS ===
+
+    // Latest published station snapshot. Call on the game thread, then hand the
+    // reference to background jobs (save, export, analysis); they may read it freely.
+    FF12StationSnapshotRef GetStationSnapshot() const { return SnapshotPublisher.GetLatest(); }
+
+    // Publish pending changes now instead of at the next Tick
+    void PublishSnapshot();
+
     // Get face transforms for ghost preview
     UFUNCTION(BlueprintCallable, Category = "F12|Geometry")
     const TArray<FTransform>& GetFaceTransforms() const { return FaceTransforms; }
 
 protected:
-    // HISM components organized by [FaceIndex * NumMaterials + MaterialIndex]
+    // HISM components organized by [ChunkIndex * ComponentsPerChunk + FaceIndex * NumMaterials + MaterialIndex]
+    // (one tile component per chunk in CustomData mode), followed in each chunk by the merged module
+    // components [TileComponentsPerChunk + MaterialIndex] (one in CustomData mode, none without MergedModuleMesh).
+    // Entries stay nullptr until the component gets its first instance.
     UPROPERTY()
     TArray<UHierarchicalInstancedStaticMeshComponent*> HISMComponents;
 
+    // Chunks in creation order; a chunk keeps its index (and components) until ClearAll
+    UPROPERTY()
+    TArray<FF12RenderChunk> Chunks;
+
+    // Lattice key of the chunk coordinate -> index in Chunks
+    TF12FlatMap<int32> ChunkLookup;
+
+    // log2 of the chunk size in cells
+    int32 ChunkShift = 4;
+
+    // Tile components per chunk (12 * NumMaterials, or 1 in CustomData mode)
+    int32 TileComponentsPerChunk = 1;
+
+    // Tile components + merged module components per chunk
+    int32 ComponentsPerChunk = 1;
+
     // Separate HISM for highlighted tiles (12 instances for full module highlight)
     UPROPERTY()
     UHierarchicalInstancedStaticMeshComponent* HighlightHISM;
@@ -203,14 +440,21 @@ protected:
     int32 HighlightedTileIndex = -1;  // -1 means full module, 0-11 means single tile
     bool bHasHighlight = false;
 
-    // Module data storage
-    UPROPERTY()
-    TMap<FF12GridCoord, FF12ModuleInstanceData> ModuleData;
+    // Tile state of every module (materials, visibility, culling, instance indices)
+    FF12ModuleStore Modules;
 
-    // Instance-to-source mapping: maps (ComponentIndex, InstanceIndex) -> (GridCoord, TileIndex)
-    // This allows us to know exactly which module/tile was hit by a raycast
-    UPROPERTY()
-    TMap<FF12InstanceKey, FF12InstanceSourceData> InstanceToSourceMap;
+    // Instance-to-source mapping: [ComponentIndex][InstanceIndex] -> tile reference (Slot * NumTiles + Tile)
+    // Same length as the component's instance count, so a raycast hit resolves to its module/tile in O(1)
+    TArray<TArray<int32>> InstanceSources;
+
+    // HISM component pointer -> index in HISMComponents
+    TF12FlatMap<int32> ComponentLookup;
+
+    // Versioned copies of Modules + grid occupancy for other threads; edits mark bricks dirty
+    FF12SnapshotPublisher SnapshotPublisher;
+
+    // A module or its tiles changed: mark its snapshot brick and the baked meshes it appears in
+    void MarkCellChanged(const FIntVector& Cell);
 
     // Cached face transforms (computed once at BeginPlay)
     TArray<FTransform> FaceTransforms;
@@ -218,22 +462,284 @@ protected:
     // Number of materials
     int32 NumMaterials = 1;
 
-    // Initialize HISM components
+    // Faces currently flagged as culled across all modules
+    int32 NumCulledFaces = 0;
+
+    // === ASYNC TREE BUILDS ===
+
+    // Component indices whose instances changed and whose tree is not built yet (value unused)
+    TF12FlatMap<uint8> PendingTreeBuilds;
+
+    // When PendingTreeBuilds last went from empty to non-empty
+    double TreeBuildStartTime = 0.0;
+
+    double LastTreeBuildLatencyMs = 0.0;
+    int32 LastTreeBuildComponents = 0;
+
+    // Components that joined the current round of tree builds
+    int32 TreeBuildComponents = 0;
+
+    // A component's instances changed: its tree is built asynchronously from the next Tick
+    void MarkTreeOutdated(int32 ComponentIndex);
+
+    // Start async builds for outdated trees and record the latency once all of them are done
+    void UpdateTreeBuilds();
+
+    // === CHUNK HLODS ===
+
+    // A bake running on a worker thread
+    struct FHLODBake
+    {
+        int32 ChunkIndex = INDEX_NONE;
+
+        // Chunk EditVersion the bake started from
+        uint32 EditVersion = 0;
+
+        TFuture<FF12BakedChunkMesh> Result;
+    };
+
+    TArray<FHLODBake> HLODBakes;
+
+    // Chunks with bShowingHLOD set
+    int32 NumHLODChunks = 0;
+
+    // Take finished bakes, start new ones for far chunks and pick each chunk's representation:
+    // instances, baked mesh (by distance) or proxies (by screen size)
+    void UpdateChunkLODs();
+
+    // Put a finished bake into the chunk's procedural mesh (game thread)
+    void ApplyHLODBake(int32 ChunkIndex, const FF12BakedChunkMesh& Mesh);
+
+    // Draw the chunk as its baked mesh or as instances
+    void SetChunkShowingHLOD(int32 ChunkIndex, bool bShowHLOD);
+
+    // Apply bHidden, bShowingHLOD and bShowingProxy to the chunk's components
+    void UpdateChunkVisibility(int32 ChunkIndex);
+
+    // === FAR-FIELD PROXIES ===
+
+    // Chunks with bShowingProxy set
+    int32 NumProxyChunks = 0;
+
+    // A chunk switches back from proxies only once its screen size exceeds ProxyScreenSize by this factor
+    static constexpr float ProxyScreenSizeHysteresis = 1.25f;
+
+    // ProxyMesh, or the merged module mesh in its place
+    UStaticMesh* GetProxyMesh() const { return ProxyMesh ? ProxyMesh : MergedModuleMesh; }
+
+    // Rebuild a chunk's proxy instances from the grid occupancy
+    void BuildChunkProxies(int32 ChunkIndex);
+
+    // Draw the chunk as its proxies or not
+    void SetChunkShowingProxy(int32 ChunkIndex, bool bShowProxy);
+
+    // The baked mesh of a chunk is out of date (the chunk draws its instances until the rebake)
+    void MarkChunkEdited(int32 ChunkIndex);
+
+    // Bake inputs for a chunk with the current settings
+    FF12ChunkBakeParams GetHLODBakeParams(int32 ChunkIndex) const;
+
+    // Create the highlight component and drop all chunks (tile components are created per chunk on demand)
     void InitializeHISMComponents();
 
+    // Destroy every chunk and its tile components
+    void DestroyChunks();
+
+    // Index in Chunks of the chunk containing Cell, or INDEX_NONE
+    int32 FindChunkIndex(const FIntVector& Cell) const;
+
+    int32 FindOrAddChunk(const FIntVector& Cell);
+
+    // Chunk of a live module
+    int32 GetSlotChunk(int32 Slot) const { return FindChunkIndex(Modules.GetCell(Slot)); }
+
     // Compute the 12 face transforms for a rhombic dodecahedron
     void ComputeFaceTransforms();
 
-    // Rebuild all instances (called after changes)
-    void RebuildInstances();
+    // Rebuild the instances of the given chunks: transforms are built in parallel (one task per
+    // chunk), then each component gets its instances in one AddInstances call and one tree build
+    void RebuildChunks(const TArray<int32>& ChunkIndices);
+
+    // Chunks built per ParallelFor wave (bounds the transient transform memory of a full rebuild)
+    static constexpr int32 RebuildWaveSize = 64;
+
+    // Build the instance batch of one chunk and assign its tiles' instance indices.
+    // Reads only module data and writes only the chunk's own slots, so chunks can be built in parallel.
+    void BuildChunkInstances(int32 ChunkIndex, double Spacing, FF12ChunkInstanceBatch& OutBatch);
+
+    // Replace a chunk's instances with a built batch (game thread)
+    void SubmitChunkInstances(int32 ChunkIndex, FF12ChunkInstanceBatch& Batch);
+
+    // Component index of a tile in a chunk given its material
+    int32 GetComponentIndex(int32 ChunkIndex, int32 TileIndex, int32 MaterialIndex) const;
+
+    // Component index of a module's tile with its current material
+    int32 GetTileComponentIndex(int32 Slot, int32 TileIndex) const;
+
+    // Component at ComponentIndex, created and registered on first use
+    UHierarchicalInstancedStaticMeshComponent* GetOrCreateComponent(int32 ComponentIndex);
+
+    bool UsesCustomData() const { return RenderMode == EF12TileRenderMode::CustomData; }
+
+    // Custom data floats per tile instance in CustomData mode (layout: see TileMasterMaterial)
+    static constexpr int32 NumTileCustomData = 5;
+
+    // A tile's paint as custom data floats (layout: see TileMasterMaterial)
+    void GetTileCustomData(int32 Slot, int32 TileIndex, float* OutCustomData) const;
+
+    // Write a tile's paint into its instance's custom data (CustomData mode)
+    void WriteTileCustomData(UHierarchicalInstancedStaticMeshComponent* HISM, int32 InstanceIndex, int32 Slot, int32 TileIndex, bool bMarkRenderStateDirty);
+
+    // Give a tile a new material (dropping any free colour): a custom data write in CustomData mode,
+    // otherwise a move between components
+    void ApplyTileMaterial(int32 Slot, int32 TileIndex, int32 MaterialIndex);
+
+    // Give a tile a free colour; returns true if the tile changed
+    bool ApplyTileColor(int32 Slot, int32 TileIndex, uint32 PackedColor);
+
+    // Free colours were set while rendering per material (warned once)
+    bool bWarnedColorWithoutCustomData = false;
+
+    // Open BeginEditBatch calls
+    int32 EditBatchDepth = 0;
+
+    // Slots whose instances are out of date in the open batch (value unused)
+    TF12FlatMap<uint8> BatchDirtySlots;
+
+    // Chunks the open batch will rebuild, so their instances are not touched until then (value unused)
+    TF12FlatMap<uint8> BatchRebuildChunks;
+
+    // Instances of these chunks are left alone until their rebuild (open batch or time-slice queue)
+    bool IsChunkRebuildPending(int32 ChunkIndex) const
+    {
+        return BatchRebuildChunks.Contains((uint64)ChunkIndex) || QueuedChunks.Contains((uint64)ChunkIndex);
+    }
 
-    // Get HISM component for a face and material
-    UHierarchicalInstancedStaticMeshComponent* GetHISMForFaceAndMaterial(int32 FaceIndex, int32 MaterialIndex);
+    // === TIME-SLICED REBUILDS ===
+
+    // Chunks waiting for a rebuild under RebuildBudgetMs (value unused)
+    TF12FlatMap<uint8> QueuedChunks;
+
+    // Measured rebuild cost, used to fill each frame's budget
+    double RebuildMsPerModule = 0.002;
+
+    // Rebuild now, or queue when bTimeSliceRebuilds is set
+    void RebuildOrQueueChunks(const TArray<int32>& ChunkIndices);
+
+    // Rebuild the queued chunks nearest to the camera until the frame budget is spent
+    void ProcessRebuildQueue();
+
+    // World location of the local player's camera; false without a player
+    bool GetViewLocation(FVector& OutLocation) const;
+
+    // Defer a module's instance updates to the end of the open batch
+    void MarkModuleDirty(int32 Slot) { BatchDirtySlots.FindOrAdd((uint64)Slot); }
+
+    // Bring one module's instances in line with its data (add, remove or rewrite per tile)
+    // Returns true if custom data was written without marking the render state dirty
+    bool SyncModuleInstances(int32 Slot);
+
+    // Does the tile get an instance? (visible, not an interior face and the module is not drawn merged)
+    bool IsTileRendered(int32 Slot, int32 TileIndex) const;
+
+    // === MERGED MODULES ===
+
+    // A uniform module is merged only while at most this many of its faces are interior; past that its
+    // remaining tile instances draw less than the 12 merged faces (and a fully enclosed module draws nothing)
+    static constexpr int32 MaxMergedCulledFaces = 4;
+
+    // Is the module drawn as one instance of MergedModuleMesh? (Only if the chunks were laid out with
+    // merged module components.) Linking or unlinking neighbors can flip the answer.
+    bool WantsMergedInstance(int32 Slot) const;
+
+    // Component of a chunk's merged modules with the given material
+    int32 GetModuleComponentIndex(int32 ChunkIndex, int32 MaterialIndex) const;
+
+    bool IsModuleComponent(int32 ComponentIndex) const { return ComponentIndex % ComponentsPerChunk >= TileComponentsPerChunk; }
+
+    // Add the merged instance of a module (its tiles must have no instances)
+    bool AddMergedInstance(int32 Slot);
+
+    // Remove the merged instance of a module, if it has one
+    void RemoveMergedInstance(int32 Slot);
+
+    // Flag or clear an interior face; with bUpdateInstances the tile's instance follows, and the
+    // module splits or re-merges when it crosses MaxMergedCulledFaces
+    void SetFaceCulled(int32 Slot, int32 Face, bool bCulled, bool bUpdateInstances);
+
+    // A module was added: cull the faces it shares with existing modules, on both sides
+    // (bUpdateInstances applies to the neighbors; the new module's instances are created afterwards)
+    void LinkNeighbors(int32 Slot, bool bUpdateInstances = true);
+
+    // A module is being removed: uncover the neighbor faces that touched it
+    void UnlinkNeighbors(int32 Slot, bool bUpdateInstances = true);
+
+    // Add the instance for one tile to the component of its current material
+    bool AddTileInstance(int32 Slot, int32 TileIndex);
+
+    // Remove the instance of one tile, if it has one
+    void RemoveTileInstanceOf(int32 Slot, int32 TileIndex);
+
+    // Remove all instances of one module (tiles and merged) and reset its instance indices
+    void RemoveModuleInstances(int32 Slot);
+
+    // Record which tile owns a new instance
+    void SetInstanceSource(int32 ComponentIndex, int32 InstanceIndex, int32 Slot, int32 TileIndex);
+
+    // Remove one instance: the component's last instance is moved into the freed slot, then the
+    // last slot is removed. Only the tail is ever removed, so no other index shifts regardless of
+    // how the HISM reorders on removal; the moved tile is patched through InstanceSources.
+    void RemoveTileInstance(int32 ComponentIndex, int32 InstanceIndex);
+
+    // Create, configure and register one tile HISM
+    UHierarchicalInstancedStaticMeshComponent* CreateTileHISM(UStaticMesh* Mesh, UMaterialInterface* Material, int32 NumCustomDataFloats);
 
     // Get world transform for a tile
     FTransform GetTileWorldTransform(FF12GridCoord GridCoord, int32 TileIndex) const;
 
+    // Tile transform for a module whose world position is already known: the precomputed face
+    // transform moved to ModulePos (modules are never rotated or scaled)
+    FTransform GetTileTransformAtPosition(const FVector& ModulePos, int32 TileIndex) const;
+
+    // Find the grid system if it has not been cached yet
+    bool ResolveGridSystem() const;
+
     // Reference to grid system for coordinate conversion
     UPROPERTY()
     AF12GridSystem* GridSystem;
-};
\ No newline at end of file
+};
+
+/**
+ * Opens an edit batch on the renderer for the lifetime of the scope.
+ *
+ *   {
+ *       FF12ScopedEditBatch Batch(Renderer);
+ *       for (...) Renderer->AddModule(...);
+ *   }   // instances committed here
+ */
+class FF12ScopedEditBatch
+{
+public:
+    explicit FF12ScopedEditBatch(AF12InstancedRenderer* InRenderer)
+        : Renderer(InRenderer)
+    {
+        if (Renderer)
+        {
+            Renderer->BeginEditBatch();
+        }
+    }
+
+    ~FF12ScopedEditBatch()
+    {
+        if (Renderer)
+        {
+            Renderer->EndEditBatch();
+        }
+    }
+
+    FF12ScopedEditBatch(const FF12ScopedEditBatch&) = delete;
+    FF12ScopedEditBatch& operator=(const FF12ScopedEditBatch&) = delete;
+
+private:
+    AF12InstancedRenderer* Renderer;
+};
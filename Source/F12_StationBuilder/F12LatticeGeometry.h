@@ -0,0 +1,260 @@
+// F12LatticeGeometry.h
+// Compile-time geometry of the rhombic dodecahedron lattice
+// Single source for neighbor offsets, face normals, opposite faces, face vertices and spacing
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace F12Lattice
+{
+    constexpr int32 NumFaces = 12;
+    constexpr int32 NumVertices = 14;
+
+    // Bit mask with one bit per face
+    constexpr uint16 AllFacesMask = (1 << NumFaces) - 1;
+
+    // sqrt(2)/2
+    constexpr float InvSqrt2 = 0.70710678f;
+
+    // Base spacing factor for the lattice (kept at the value the grid has always used)
+    constexpr float SpacingFactor = 0.707f;
+
+    // Grid offset to the neighbor across each face.
+    // Every offset has two +-1 components, so neighbors keep the even X+Y+Z parity.
+    constexpr int32 NeighborOffsets[NumFaces][3] =
+    {
+        // Faces 0-3: around +X octahedral
+        { 1,  0, -1},   // Face 0: +X, -Z
+        { 1, -1,  0},   // Face 1: +X, -Y
+        { 1,  0,  1},   // Face 2: +X, +Z
+        { 1,  1,  0},   // Face 3: +X, +Y
+
+        // Faces 4-7: around -X octahedral
+        {-1,  0, -1},   // Face 4: -X, -Z
+        {-1,  1,  0},   // Face 5: -X, +Y
+        {-1,  0,  1},   // Face 6: -X, +Z
+        {-1, -1,  0},   // Face 7: -X, -Y
+
+        // Faces 8-11: connecting Y and Z axes
+        { 0,  1,  1},   // Face 8: +Y, +Z
+        { 0,  1, -1},   // Face 9: +Y, -Z
+        { 0, -1,  1},   // Face 10: -Y, +Z
+        { 0, -1, -1},   // Face 11: -Y, -Z
+    };
+
+    // Outward unit normal of each face (NeighborOffsets / sqrt(2))
+    constexpr float FaceNormals[NumFaces][3] =
+    {
+        { InvSqrt2,  0.0f,     -InvSqrt2},
+        { InvSqrt2, -InvSqrt2,  0.0f    },
+        { InvSqrt2,  0.0f,      InvSqrt2},
+        { InvSqrt2,  InvSqrt2,  0.0f    },
+        {-InvSqrt2,  0.0f,     -InvSqrt2},
+        {-InvSqrt2,  InvSqrt2,  0.0f    },
+        {-InvSqrt2,  0.0f,      InvSqrt2},
+        {-InvSqrt2, -InvSqrt2,  0.0f    },
+        { 0.0f,      InvSqrt2,  InvSqrt2},
+        { 0.0f,      InvSqrt2, -InvSqrt2},
+        { 0.0f,     -InvSqrt2,  InvSqrt2},
+        { 0.0f,     -InvSqrt2, -InvSqrt2},
+    };
+
+    // Face on the neighbor that touches each face (its offset is the negation)
+    constexpr int32 OppositeFace[NumFaces] = { 6, 5, 4, 7, 2, 1, 0, 3, 11, 10, 9, 8 };
+
+    // The 14 vertices in units of R/sqrt(2), where R = ModuleSize/2
+    constexpr int32 VertexDirs[NumVertices][3] =
+    {
+        // Cubic vertices
+        {-1, -1, -1}, { 1, -1, -1}, {-1,  1, -1}, { 1,  1, -1},
+        {-1, -1,  1}, { 1, -1,  1}, {-1,  1,  1}, { 1,  1,  1},
+
+        // Octahedral vertices
+        { 2,  0,  0}, {-2,  0,  0}, { 0,  2,  0}, { 0, -2,  0}, { 0,  0,  2}, { 0,  0, -2},
+    };
+
+    // Face definitions: [cubic1, octahedral1, cubic2, octahedral2]
+    constexpr int32 FaceVertices[NumFaces][4] =
+    {
+        {3, 8, 1, 13},   // Face 0
+        {1, 8, 5, 11},   // Face 1
+        {5, 8, 7, 12},   // Face 2
+        {7, 8, 3, 10},   // Face 3
+        {0, 9, 2, 13},   // Face 4
+        {2, 9, 6, 10},   // Face 5
+        {6, 9, 4, 12},   // Face 6
+        {4, 9, 0, 11},   // Face 7
+        {7, 10, 6, 12},  // Face 8
+        {2, 10, 3, 13},  // Face 9
+        {4, 11, 5, 12},  // Face 10
+        {1, 11, 0, 13},  // Face 11
+    };
+
+    // === CONSISTENCY CHECKS ===
+
+    namespace Private
+    {
+        constexpr int32 Abs(int32 V) { return V < 0 ? -V : V; }
+
+        constexpr bool OffsetsAreFaceDiagonals()
+        {
+            for (int32 Face = 0; Face < NumFaces; Face++)
+            {
+                const int32* O = NeighborOffsets[Face];
+                if (Abs(O[0]) + Abs(O[1]) + Abs(O[2]) != 2 || Abs(O[0]) > 1 || Abs(O[1]) > 1 || Abs(O[2]) > 1)
+                    return false;
+            }
+            return true;
+        }
+
+        constexpr bool NormalsMatchOffsets()
+        {
+            for (int32 Face = 0; Face < NumFaces; Face++)
+            {
+                for (int32 Axis = 0; Axis < 3; Axis++)
+                {
+                    if (FaceNormals[Face][Axis] != NeighborOffsets[Face][Axis] * InvSqrt2)
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        constexpr bool OppositesAreConsistent()
+        {
+            for (int32 Face = 0; Face < NumFaces; Face++)
+            {
+                const int32 Opp = OppositeFace[Face];
+                if (OppositeFace[Opp] != Face)
+                    return false;
+                for (int32 Axis = 0; Axis < 3; Axis++)
+                {
+                    if (NeighborOffsets[Opp][Axis] != -NeighborOffsets[Face][Axis])
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        // The four vertices of a face average to its center, which lies along the neighbor offset
+        constexpr bool VerticesMatchOffsets()
+        {
+            for (int32 Face = 0; Face < NumFaces; Face++)
+            {
+                for (int32 Axis = 0; Axis < 3; Axis++)
+                {
+                    int32 Sum = 0;
+                    for (int32 Corner = 0; Corner < 4; Corner++)
+                    {
+                        Sum += VertexDirs[FaceVertices[Face][Corner]][Axis];
+                    }
+                    if (Sum != 4 * NeighborOffsets[Face][Axis])
+                        return false;
+                }
+            }
+            return true;
+        }
+    }
+
+    static_assert(Private::OffsetsAreFaceDiagonals(), "Neighbor offsets must be the 12 face diagonals of the unit cube");
+    static_assert(Private::NormalsMatchOffsets(), "Face normals must equal neighbor offsets / sqrt(2)");
+    static_assert(Private::OppositesAreConsistent(), "OppositeFace must pair each face with its negated offset");
+    static_assert(Private::VerticesMatchOffsets(), "Face vertices must be centered on the matching neighbor offset");
+
+    // === ACCESSORS (no allocation) ===
+
+    FORCEINLINE bool IsValidFace(int32 Face)
+    {
+        return Face >= 0 && Face < NumFaces;
+    }
+
+    FORCEINLINE FIntVector GetNeighborOffset(int32 Face)
+    {
+        return FIntVector(NeighborOffsets[Face][0], NeighborOffsets[Face][1], NeighborOffsets[Face][2]);
+    }
+
+    FORCEINLINE FIntVector GetNeighbor(const FIntVector& Cell, int32 Face)
+    {
+        return FIntVector(Cell.X + NeighborOffsets[Face][0], Cell.Y + NeighborOffsets[Face][1], Cell.Z + NeighborOffsets[Face][2]);
+    }
+
+    FORCEINLINE FVector GetFaceNormal(int32 Face)
+    {
+        return FVector(FaceNormals[Face][0], FaceNormals[Face][1], FaceNormals[Face][2]);
+    }
+
+    // Vertex position for a module of the given size
+    FORCEINLINE FVector GetVertex(int32 Vertex, float ModuleSize)
+    {
+        const float Scale = ModuleSize * 0.5f * InvSqrt2;
+        return FVector(VertexDirs[Vertex][0], VertexDirs[Vertex][1], VertexDirs[Vertex][2]) * Scale;
+    }
+
+    // Distance between lattice points along one grid axis.
+    // Accounts for tile thickness so tiles of neighboring modules just touch:
+    // center-to-center = 2 * (R + T/2), base BCC factor sqrt(2)/2.
+    FORCEINLINE constexpr float GetAdjustedSpacing(float ModuleSize, float TileThickness)
+    {
+        return SpacingFactor * (ModuleSize + TileThickness);
+    }
+
+    // Distance between adjacent module centers (offsets like (1,0,-1) have length sqrt(2))
+    FORCEINLINE float GetModuleSpacing(float ModuleSize, float TileThickness)
+    {
+        return GetAdjustedSpacing(ModuleSize, TileThickness) * UE_SQRT_2;
+    }
+
+    // Closest lattice point (X+Y+Z even) to a position given in grid units.
+    // Round every axis; if the sum comes out odd, round the axis that was furthest
+    // from its integer the other way instead (the standard D3 lattice decoder).
+    // Ties go to the lower axis and to the positive side, matching the batched path.
+    FORCEINLINE FIntVector NearestLatticePoint(double X, double Y, double Z)
+    {
+        const double RX = FMath::FloorToDouble(X + 0.5);
+        const double RY = FMath::FloorToDouble(Y + 0.5);
+        const double RZ = FMath::FloorToDouble(Z + 0.5);
+
+        FIntVector Cell((int32)RX, (int32)RY, (int32)RZ);
+        if ((Cell.X + Cell.Y + Cell.Z) & 1)
+        {
+            const double DX = X - RX;
+            const double DY = Y - RY;
+            const double DZ = Z - RZ;
+            const double AX = FMath::Abs(DX);
+            const double AY = FMath::Abs(DY);
+            const double AZ = FMath::Abs(DZ);
+
+            if (AX >= AY && AX >= AZ)
+            {
+                Cell.X += DX >= 0.0 ? 1 : -1;
+            }
+            else if (AY >= AZ)
+            {
+                Cell.Y += DY >= 0.0 ? 1 : -1;
+            }
+            else
+            {
+                Cell.Z += DZ >= 0.0 ? 1 : -1;
+            }
+        }
+        return Cell;
+    }
+
+    // Face whose normal is best aligned with Direction (need not be normalized)
+    FORCEINLINE int32 GetFaceForDirection(const FVector& Direction)
+    {
+        int32 BestFace = 0;
+        double BestDot = -UE_BIG_NUMBER;
+        for (int32 Face = 0; Face < NumFaces; Face++)
+        {
+            const double Dot = Direction.X * NeighborOffsets[Face][0] + Direction.Y * NeighborOffsets[Face][1] + Direction.Z * NeighborOffsets[Face][2];
+            if (Dot > BestDot)
+            {
+                BestDot = Dot;
+                BestFace = Face;
+            }
+        }
+        return BestFace;
+    }
+}
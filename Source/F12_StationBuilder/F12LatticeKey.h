@@ -0,0 +1,108 @@
+// F12LatticeKey.h
+// Packed 64-bit lattice keys: 21 bits per axis, Morton (Z-order) interleaved
+// Sorting by key walks the lattice in a spatially coherent order
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Use BMI2 PDEP/PEXT when the target is guaranteed to have it (AVX2 implies BMI2 on all shipping CPUs)
+#if defined(__BMI2__) || (defined(_MSC_VER) && defined(__AVX2__))
+    #define F12_LATTICE_KEY_BMI2 1
+    #include <immintrin.h>
+#else
+    #define F12_LATTICE_KEY_BMI2 0
+#endif
+
+namespace F12LatticeKey
+{
+    // Bits per axis and the signed coordinate range they cover: [-2^20, 2^20 - 1]
+    constexpr int32 BitsPerAxis = 21;
+    constexpr int32 Bias = 1 << (BitsPerAxis - 1);
+    constexpr uint64 AxisMask = (1ull << BitsPerAxis) - 1;
+
+    // Bit positions owned by each axis in the interleaved key
+    constexpr uint64 MortonMaskX = 0x1249249249249249ull;
+    constexpr uint64 MortonMaskY = MortonMaskX << 1;
+    constexpr uint64 MortonMaskZ = MortonMaskX << 2;
+
+    // Never produced by Encode (bit 63 is always clear), used as an empty-slot marker
+    constexpr uint64 InvalidKey = ~0ull;
+
+    FORCEINLINE constexpr bool IsInRange(int32 Value)
+    {
+        return Value >= -Bias && Value < Bias;
+    }
+
+    // Out-of-range coordinates would alias onto other keys: lookups must check this first
+    FORCEINLINE constexpr bool IsInRange(const FIntVector& V)
+    {
+        return IsInRange(V.X) && IsInRange(V.Y) && IsInRange(V.Z);
+    }
+
+    // Cells that may be stored: in range with a one-cell margin, so their 12 neighbors are encodable too
+    FORCEINLINE constexpr bool IsStorableCell(const FIntVector& Cell)
+    {
+        return Cell.X > -Bias && Cell.X < Bias - 1
+            && Cell.Y > -Bias && Cell.Y < Bias - 1
+            && Cell.Z > -Bias && Cell.Z < Bias - 1;
+    }
+
+    // Spread the low 21 bits of V so there are two zero bits between each
+    FORCEINLINE uint64 SplitBy3(uint64 V)
+    {
+        V &= AxisMask;
+        V = (V | (V << 32)) & 0x001f00000000ffffull;
+        V = (V | (V << 16)) & 0x001f0000ff0000ffull;
+        V = (V | (V << 8))  & 0x100f00f00f00f00full;
+        V = (V | (V << 4))  & 0x10c30c30c30c30c3ull;
+        V = (V | (V << 2))  & 0x1249249249249249ull;
+        return V;
+    }
+
+    // Inverse of SplitBy3
+    FORCEINLINE uint64 CompactBy3(uint64 V)
+    {
+        V &= 0x1249249249249249ull;
+        V = (V ^ (V >> 2))  & 0x10c30c30c30c30c3ull;
+        V = (V ^ (V >> 4))  & 0x100f00f00f00f00full;
+        V = (V ^ (V >> 8))  & 0x001f0000ff0000ffull;
+        V = (V ^ (V >> 16)) & 0x001f00000000ffffull;
+        V = (V ^ (V >> 32)) & AxisMask;
+        return V;
+    }
+
+    FORCEINLINE uint64 Encode(int32 X, int32 Y, int32 Z)
+    {
+        checkSlow(IsInRange(X) && IsInRange(Y) && IsInRange(Z));
+
+        const uint64 UX = (uint64)(uint32)(X + Bias) & AxisMask;
+        const uint64 UY = (uint64)(uint32)(Y + Bias) & AxisMask;
+        const uint64 UZ = (uint64)(uint32)(Z + Bias) & AxisMask;
+
+#if F12_LATTICE_KEY_BMI2
+        return _pdep_u64(UX, MortonMaskX) | _pdep_u64(UY, MortonMaskY) | _pdep_u64(UZ, MortonMaskZ);
+#else
+        return SplitBy3(UX) | (SplitBy3(UY) << 1) | (SplitBy3(UZ) << 2);
+#endif
+    }
+
+    FORCEINLINE uint64 Encode(const FIntVector& V)
+    {
+        return Encode(V.X, V.Y, V.Z);
+    }
+
+    FORCEINLINE FIntVector Decode(uint64 Key)
+    {
+#if F12_LATTICE_KEY_BMI2
+        const uint64 UX = _pext_u64(Key, MortonMaskX);
+        const uint64 UY = _pext_u64(Key, MortonMaskY);
+        const uint64 UZ = _pext_u64(Key, MortonMaskZ);
+#else
+        const uint64 UX = CompactBy3(Key);
+        const uint64 UY = CompactBy3(Key >> 1);
+        const uint64 UZ = CompactBy3(Key >> 2);
+#endif
+        return FIntVector((int32)UX - Bias, (int32)UY - Bias, (int32)UZ - Bias);
+    }
+}
@@ -0,0 +1,141 @@
+// F12ModuleStore.cpp
+// Implementation of the dense module store
+
+#include "F12ModuleStore.h"
+
+int32 FF12ModuleStore::Add(const FIntVector& Cell, int32 Material)
+{
+    const uint64 CellKey = F12LatticeKey::Encode(Cell);
+    if (SlotLookup.Contains(CellKey))
+        return INDEX_NONE;
+
+    // Allocate a slot (reuse a freed one if possible)
+    int32 Slot;
+    if (FreeSlots.Num() > 0)
+    {
+        Slot = FreeSlots.Pop(EAllowShrinking::No);
+        LiveSlots[Slot] = true;
+    }
+    else
+    {
+        Slot = Cells.AddUninitialized();
+        VisibleMasks.AddUninitialized();
+        CulledMasks.AddUninitialized();
+        ColoredMasks.AddUninitialized();
+        ModuleInstanceIndices.AddUninitialized();
+        LiveSlots.Add(true);
+        Materials.AddUninitialized(NumTiles);
+        InstanceIndices.AddUninitialized(NumTiles);
+    }
+
+    Cells[Slot] = Cell;
+    VisibleMasks[Slot] = F12Lattice::AllFacesMask;
+    CulledMasks[Slot] = 0;
+    ColoredMasks[Slot] = 0;
+    ModuleInstanceIndices[Slot] = INDEX_NONE;
+
+    const uint8 PackedMaterial = (uint8)FMath::Clamp(Material, 0, MaxMaterial);
+    for (int32 Tile = 0; Tile < NumTiles; Tile++)
+    {
+        Materials[Slot * NumTiles + Tile] = PackedMaterial;
+        InstanceIndices[Slot * NumTiles + Tile] = INDEX_NONE;
+    }
+
+    SlotLookup.Add(CellKey, Slot);
+    return Slot;
+}
+
+bool FF12ModuleStore::Remove(const FIntVector& Cell)
+{
+    int32 Slot;
+    if (!SlotLookup.RemoveAndCopyValue(F12LatticeKey::Encode(Cell), Slot))
+        return false;
+
+    if (ColoredMasks[Slot] != 0)
+    {
+        TileColors.Remove((uint64)Slot);
+        ColoredMasks[Slot] = 0;
+    }
+
+    LiveSlots[Slot] = false;
+    FreeSlots.Add(Slot);
+    return true;
+}
+
+void FF12ModuleStore::Reserve(int32 NumModules)
+{
+    // Slots include the free ones, which new modules reuse first,
+    // so NumModules live modules never need more than NumModules slots
+    const int32 NumSlots = FMath::Max(NumModules, Cells.Num());
+    Cells.Reserve(NumSlots);
+    VisibleMasks.Reserve(NumSlots);
+    CulledMasks.Reserve(NumSlots);
+    ColoredMasks.Reserve(NumSlots);
+    ModuleInstanceIndices.Reserve(NumSlots);
+    LiveSlots.Reserve(NumSlots);
+    Materials.Reserve(NumSlots * NumTiles);
+    InstanceIndices.Reserve(NumSlots * NumTiles);
+    SlotLookup.Reserve(NumModules);
+}
+
+void FF12ModuleStore::Reset()
+{
+    Cells.Reset();
+    VisibleMasks.Reset();
+    CulledMasks.Reset();
+    ColoredMasks.Reset();
+    ModuleInstanceIndices.Reset();
+    LiveSlots.Reset();
+    Materials.Reset();
+    InstanceIndices.Reset();
+    FreeSlots.Reset();
+    SlotLookup.Reset();
+    TileColors.Reset();
+}
+
+void FF12ModuleStore::Empty()
+{
+    Cells.Empty();
+    VisibleMasks.Empty();
+    CulledMasks.Empty();
+    ColoredMasks.Empty();
+    ModuleInstanceIndices.Empty();
+    LiveSlots.Empty();
+    Materials.Empty();
+    InstanceIndices.Empty();
+    FreeSlots.Empty();
+    SlotLookup.Empty();
+    TileColors.Empty();
+}
+
+SIZE_T FF12ModuleStore::GetAllocatedSize() const
+{
+    return Cells.GetAllocatedSize() + VisibleMasks.GetAllocatedSize() + CulledMasks.GetAllocatedSize()
+        + ColoredMasks.GetAllocatedSize() + ModuleInstanceIndices.GetAllocatedSize() + LiveSlots.GetAllocatedSize() + Materials.GetAllocatedSize()
+        + InstanceIndices.GetAllocatedSize() + FreeSlots.GetAllocatedSize() + SlotLookup.GetAllocatedSize()
+        + TileColors.GetAllocatedSize();
+}
+
+// === FREE COLOURS ===
+
+void FF12ModuleStore::SetTileColor(int32 Slot, int32 Tile, uint32 PackedColor)
+{
+    TileColors.FindOrAdd((uint64)Slot).Packed[Tile] = PackedColor;
+    SetMaskBit(ColoredMasks[Slot], Tile, true);
+}
+
+void FF12ModuleStore::ClearTileColor(int32 Slot, int32 Tile)
+{
+    if (!HasTileColor(Slot, Tile))
+        return;
+
+    SetMaskBit(ColoredMasks[Slot], Tile, false);
+    if (ColoredMasks[Slot] == 0)
+    {
+        TileColors.Remove((uint64)Slot);
+    }
+    else if (FTileColors* Colors = TileColors.Find((uint64)Slot))
+    {
+        Colors->Packed[Tile] = 0;
+    }
+}
@@ -0,0 +1,160 @@
+// F12ModuleStore.h
+// Dense per-module tile records for the instanced renderer
+// Structure-of-arrays slots recycled through a free list and found by lattice key
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "F12FlatMap.h"
+#include "F12LatticeGeometry.h"
+
+/**
+ * Tile state of every placed module, stored as parallel arrays indexed by slot.
+ *
+ * Per module: its cell, 12 packed material indices, 12 tile instance indices, one merged
+ * module instance index and three 12-bit tile masks (visible, culled, free colour). Free paint colours are rare and
+ * live in a side table keyed by slot. Removing a module puts its slot on a free list;
+ * slots of live modules never move, so a slot stays valid until its module is removed.
+ */
+class FF12ModuleStore
+{
+public:
+    static constexpr int32 NumTiles = F12Lattice::NumFaces;
+
+    // Highest material index a tile can hold
+    static constexpr int32 MaxMaterial = 255;
+
+    // === MODULES ===
+
+    // Slot of the module at Cell, or INDEX_NONE
+    int32 Find(const FIntVector& Cell) const
+    {
+        if (!F12LatticeKey::IsInRange(Cell))
+            return INDEX_NONE;
+
+        const int32* Slot = SlotLookup.Find(F12LatticeKey::Encode(Cell));
+        return Slot ? *Slot : INDEX_NONE;
+    }
+
+    bool Contains(const FIntVector& Cell) const { return F12LatticeKey::IsInRange(Cell) && SlotLookup.Contains(F12LatticeKey::Encode(Cell)); }
+
+    // Add a module with every tile visible and painted Material.
+    // Returns the new slot, or INDEX_NONE if Cell already has a module.
+    int32 Add(const FIntVector& Cell, int32 Material);
+
+    // Free the module's slot; returns false if Cell has no module
+    bool Remove(const FIntVector& Cell);
+
+    // Number of modules
+    int32 Num() const { return SlotLookup.Num(); }
+
+    // Make room for NumModules modules without reallocating
+    void Reserve(int32 NumModules);
+
+    // Remove every module but keep the allocations
+    void Reset();
+
+    // Remove every module and free all memory
+    void Empty();
+
+    SIZE_T GetAllocatedSize() const;
+
+    // Visit every module in slot order: Func(int32 Slot)
+    template <typename FuncType>
+    void ForEach(FuncType&& Func) const
+    {
+        for (int32 Slot = 0; Slot < Cells.Num(); Slot++)
+        {
+            if (LiveSlots[Slot])
+            {
+                Func(Slot);
+            }
+        }
+    }
+
+    // === PER-SLOT ACCESS (Slot must belong to a module) ===
+
+    const FIntVector& GetCell(int32 Slot) const { return Cells[Slot]; }
+
+    int32 GetMaterial(int32 Slot, int32 Tile) const { return Materials[Slot * NumTiles + Tile]; }
+    void SetMaterial(int32 Slot, int32 Tile, int32 Material) { Materials[Slot * NumTiles + Tile] = (uint8)FMath::Clamp(Material, 0, MaxMaterial); }
+
+    // Bit N set = tile N visible
+    uint16 GetVisibleMask(int32 Slot) const { return VisibleMasks[Slot]; }
+    bool IsVisible(int32 Slot, int32 Tile) const { return (VisibleMasks[Slot] & (1 << Tile)) != 0; }
+    void SetVisible(int32 Slot, int32 Tile, bool bVisible) { SetMaskBit(VisibleMasks[Slot], Tile, bVisible); }
+
+    // Bit N set = face N touches another module (kept apart from the user's visibility)
+    uint16 GetCulledMask(int32 Slot) const { return CulledMasks[Slot]; }
+    bool IsCulled(int32 Slot, int32 Tile) const { return (CulledMasks[Slot] & (1 << Tile)) != 0; }
+    void SetCulled(int32 Slot, int32 Tile, bool bCulled) { SetMaskBit(CulledMasks[Slot], Tile, bCulled); }
+
+    // HISM instance index of each tile (INDEX_NONE = no instance)
+    int32 GetInstanceIndex(int32 Slot, int32 Tile) const { return InstanceIndices[Slot * NumTiles + Tile]; }
+    void SetInstanceIndex(int32 Slot, int32 Tile, int32 InstanceIndex) { InstanceIndices[Slot * NumTiles + Tile] = InstanceIndex; }
+
+    // Instance index of the module drawn as one merged mesh (INDEX_NONE = drawn per tile)
+    int32 GetModuleInstanceIndex(int32 Slot) const { return ModuleInstanceIndices[Slot]; }
+    void SetModuleInstanceIndex(int32 Slot, int32 InstanceIndex) { ModuleInstanceIndices[Slot] = InstanceIndex; }
+
+    // All tiles visible, one material and no free colours: the module looks like the merged mesh
+    bool IsUniform(int32 Slot) const
+    {
+        if (VisibleMasks[Slot] != F12Lattice::AllFacesMask || ColoredMasks[Slot] != 0)
+            return false;
+
+        const uint8* TileMaterials = &Materials[Slot * NumTiles];
+        for (int32 Tile = 1; Tile < NumTiles; Tile++)
+        {
+            if (TileMaterials[Tile] != TileMaterials[0])
+                return false;
+        }
+        return true;
+    }
+
+    // Bit N set = tile N is painted with a free colour instead of its material
+    uint16 GetColoredMask(int32 Slot) const { return ColoredMasks[Slot]; }
+    bool HasTileColor(int32 Slot, int32 Tile) const { return (ColoredMasks[Slot] & (1 << Tile)) != 0; }
+
+    // Free colour of a tile, packed by F12TilePaint::Pack (0 if the tile has none)
+    uint32 GetTileColor(int32 Slot, int32 Tile) const
+    {
+        const FTileColors* Colors = HasTileColor(Slot, Tile) ? TileColors.Find((uint64)Slot) : nullptr;
+        return Colors ? Colors->Packed[Tile] : 0;
+    }
+
+    void SetTileColor(int32 Slot, int32 Tile, uint32 PackedColor);
+    void ClearTileColor(int32 Slot, int32 Tile);
+
+private:
+    struct FTileColors
+    {
+        uint32 Packed[NumTiles] = {};
+    };
+
+    static FORCEINLINE void SetMaskBit(uint16& Mask, int32 Bit, bool bSet)
+    {
+        Mask = bSet ? (Mask | (1 << Bit)) : (Mask & ~(1 << Bit));
+    }
+
+    // One entry per slot
+    TArray<FIntVector> Cells;
+    TArray<uint16> VisibleMasks;
+    TArray<uint16> CulledMasks;
+    TArray<uint16> ColoredMasks;
+    TArray<int32> ModuleInstanceIndices;
+    TBitArray<> LiveSlots;
+
+    // NumTiles entries per slot
+    TArray<uint8> Materials;
+    TArray<int32> InstanceIndices;
+
+    // Slots of removed modules, reused by Add
+    TArray<int32> FreeSlots;
+
+    // Lattice key of the cell -> slot
+    TF12FlatMap<int32> SlotLookup;
+
+    // Slot -> free colours (only slots with a non-zero ColoredMasks entry)
+    TF12FlatMap<FTileColors> TileColors;
+};
@@ -0,0 +1,545 @@
+// F12OccupancyStore.cpp
+// Implementation of the sparse brick occupancy set
+
+#include "F12OccupancyStore.h"
+#include "Async/ParallelFor.h"
+
+bool FF12OccupancyStore::IsOccupied(const FIntVector& Cell) const
+{
+    const FF12OccupancyBrick* Brick = FindBrick(GetBrickCoord(Cell));
+    return Brick && Brick->TestBit(GetBitInBrick(Cell));
+}
+
+int32 FF12OccupancyStore::FindBrickIndex(const FIntVector& BrickCoord) const
+{
+    if (!F12LatticeKey::IsInRange(BrickCoord))
+        return INDEX_NONE;
+
+    const int32* Found = BrickLookup.Find(F12LatticeKey::Encode(BrickCoord));
+    return Found ? *Found : INDEX_NONE;
+}
+
+int32 FF12OccupancyStore::FindOrAddBrick(const FIntVector& BrickCoord)
+{
+    const uint64 BrickKey = F12LatticeKey::Encode(BrickCoord);
+    if (const int32* Found = BrickLookup.Find(BrickKey))
+    {
+        return *Found;
+    }
+
+    // Allocate a brick (reuse a freed one if possible)
+    int32 BrickIdx;
+    if (FreeBricks.Num() > 0)
+    {
+        BrickIdx = FreeBricks.Pop(EAllowShrinking::No);
+        Bricks[BrickIdx] = FF12OccupancyBrick();
+        MaskBlocks[BrickIdx] = FF12NeighborMaskBlock();
+    }
+    else
+    {
+        BrickIdx = Bricks.AddDefaulted();
+        MaskBlocks.AddDefaulted();
+    }
+
+    Bricks[BrickIdx].BrickCoord = BrickCoord;
+    BrickLookup.Add(BrickKey, BrickIdx);
+    AddBrickToLevels(BrickCoord);
+    return BrickIdx;
+}
+
+bool FF12OccupancyStore::SetBit(const FIntVector& Cell, int32& OutBrickIdx)
+{
+    // Odd-parity cells are not lattice points and have no neighbor mask slot
+    OutBrickIdx = INDEX_NONE;
+    if (!IsLatticeCell(Cell))
+        return false;
+
+    OutBrickIdx = FindOrAddBrick(GetBrickCoord(Cell));
+
+    FF12OccupancyBrick& Brick = Bricks[OutBrickIdx];
+    const int32 Bit = GetBitInBrick(Cell);
+    const uint64 Mask = 1ull << (Bit & 63);
+    uint64& Word = Brick.Words[Bit >> 6];
+
+    if (Word & Mask)
+        return false;  // Already occupied
+
+    Word |= Mask;
+    Brick.Count++;
+    NumOccupied++;
+    return true;
+}
+
+bool FF12OccupancyStore::Set(const FIntVector& Cell)
+{
+    int32 BrickIdx;
+    if (!SetBit(Cell, BrickIdx))
+        return false;
+
+    // Link with occupied neighbors in both directions.
+    // Most neighbors share the brick, so skip the lookup for those.
+    const FIntVector BrickCoord = Bricks[BrickIdx].BrickCoord;
+    uint16 CellMask = 0;
+
+    for (int32 Face = 0; Face < F12Lattice::NumFaces; Face++)
+    {
+        const FIntVector Neighbor = F12Lattice::GetNeighbor(Cell, Face);
+        const FIntVector NeighborBrick = GetBrickCoord(Neighbor);
+        const int32 NeighborIdx = NeighborBrick == BrickCoord ? BrickIdx : FindBrickIndex(NeighborBrick);
+        if (NeighborIdx == INDEX_NONE)
+            continue;
+
+        const int32 NeighborBit = GetBitInBrick(Neighbor);
+        if (!Bricks[NeighborIdx].TestBit(NeighborBit))
+            continue;
+
+        CellMask |= 1 << Face;
+        MaskBlocks[NeighborIdx].Get(NeighborBit) |= 1 << F12Lattice::OppositeFace[Face];
+    }
+
+    MaskBlocks[BrickIdx].Get(GetBitInBrick(Cell)) = CellMask;
+    return true;
+}
+
+bool FF12OccupancyStore::Clear(const FIntVector& Cell)
+{
+    const FIntVector BrickCoord = GetBrickCoord(Cell);
+    if (!F12LatticeKey::IsInRange(BrickCoord))
+        return false;
+
+    const uint64 BrickKey = F12LatticeKey::Encode(BrickCoord);
+    const int32* Found = BrickLookup.Find(BrickKey);
+    if (!Found)
+        return false;
+
+    const int32 BrickIdx = *Found;
+    FF12OccupancyBrick& Brick = Bricks[BrickIdx];
+    const int32 Bit = GetBitInBrick(Cell);
+    const uint64 Mask = 1ull << (Bit & 63);
+    uint64& Word = Brick.Words[Bit >> 6];
+
+    if (!(Word & Mask))
+        return false;
+
+    Word &= ~Mask;
+    Brick.Count--;
+    NumOccupied--;
+
+    // Unlink from the neighbors recorded in the mask
+    uint16 CellMask = MaskBlocks[BrickIdx].Get(Bit);
+    MaskBlocks[BrickIdx].Get(Bit) = 0;
+
+    while (CellMask)
+    {
+        const int32 Face = (int32)FMath::CountTrailingZeros((uint32)CellMask);
+        CellMask &= CellMask - 1;
+
+        const FIntVector Neighbor = F12Lattice::GetNeighbor(Cell, Face);
+        const FIntVector NeighborBrick = GetBrickCoord(Neighbor);
+        const int32 NeighborIdx = NeighborBrick == BrickCoord ? BrickIdx : FindBrickIndex(NeighborBrick);
+        if (NeighborIdx != INDEX_NONE)
+        {
+            MaskBlocks[NeighborIdx].Get(GetBitInBrick(Neighbor)) &= ~(1 << F12Lattice::OppositeFace[Face]);
+        }
+    }
+
+    // Release empty bricks so sparse stations stay small
+    if (Brick.Count == 0)
+    {
+        BrickLookup.Remove(BrickKey);
+        FreeBricks.Add(BrickIdx);
+        RemoveBrickFromLevels(BrickCoord);
+    }
+
+    return true;
+}
+
+int32 FF12OccupancyStore::SetBulk(TConstArrayView<FIntVector> Cells, TArray<FIntVector>* OutAdded)
+{
+    // Bricks whose masks need recomputing: every brick that received a cell
+    TArray<int32> DirtyBricks;
+    TBitArray<> IsDirty;
+    int32 NumAdded = 0;
+
+    for (const FIntVector& Cell : Cells)
+    {
+        int32 BrickIdx;
+        if (!SetBit(Cell, BrickIdx))
+            continue;
+
+        NumAdded++;
+        if (OutAdded)
+        {
+            OutAdded->Add(Cell);
+        }
+
+        if (BrickIdx >= IsDirty.Num())
+        {
+            IsDirty.Add(false, Bricks.Num() - IsDirty.Num());
+        }
+        if (!IsDirty[BrickIdx])
+        {
+            IsDirty[BrickIdx] = true;
+            DirtyBricks.Add(BrickIdx);
+        }
+    }
+
+    if (NumAdded == 0)
+        return 0;
+
+    // Large batches touch most of the station anyway
+    if (NumAdded * 2 >= NumOccupied)
+    {
+        RebuildNeighborMasks();
+        return NumAdded;
+    }
+
+    // Cells in adjacent bricks may have gained a neighbor across the brick boundary
+    IsDirty.Add(false, Bricks.Num() - IsDirty.Num());
+    const int32 NumTouched = DirtyBricks.Num();
+    for (int32 i = 0; i < NumTouched; i++)
+    {
+        const FIntVector Center = Bricks[DirtyBricks[i]].BrickCoord;
+        for (int32 DZ = -1; DZ <= 1; DZ++)
+        {
+            for (int32 DY = -1; DY <= 1; DY++)
+            {
+                for (int32 DX = -1; DX <= 1; DX++)
+                {
+                    const int32 AdjacentIdx = FindBrickIndex(Center + FIntVector(DX, DY, DZ));
+                    if (AdjacentIdx != INDEX_NONE && !IsDirty[AdjacentIdx])
+                    {
+                        IsDirty[AdjacentIdx] = true;
+                        DirtyBricks.Add(AdjacentIdx);
+                    }
+                }
+            }
+        }
+    }
+
+    RebuildNeighborMasksForBricks(DirtyBricks);
+    return NumAdded;
+}
+
+uint16 FF12OccupancyStore::GetNeighborMask(const FIntVector& Cell) const
+{
+    const int32 BrickIdx = FindBrickIndex(GetBrickCoord(Cell));
+    if (BrickIdx == INDEX_NONE)
+        return 0;
+
+    const int32 Bit = GetBitInBrick(Cell);
+    return Bricks[BrickIdx].TestBit(Bit) ? MaskBlocks[BrickIdx].Get(Bit) : 0;
+}
+
+uint16 FF12OccupancyStore::ComputeNeighborMask(const FIntVector& Cell) const
+{
+    uint16 Mask = 0;
+    for (int32 Face = 0; Face < F12Lattice::NumFaces; Face++)
+    {
+        if (IsOccupied(F12Lattice::GetNeighbor(Cell, Face)))
+        {
+            Mask |= 1 << Face;
+        }
+    }
+    return Mask;
+}
+
+void FF12OccupancyStore::RebuildNeighborMasks()
+{
+    TArray<int32> LiveBricks;
+    LiveBricks.Reserve(BrickLookup.Num());
+    for (int32 BrickIdx = 0; BrickIdx < Bricks.Num(); BrickIdx++)
+    {
+        if (Bricks[BrickIdx].Count > 0)
+        {
+            LiveBricks.Add(BrickIdx);
+        }
+    }
+
+    RebuildNeighborMasksForBricks(LiveBricks);
+}
+
+void FF12OccupancyStore::RebuildNeighborMasksForBricks(const TArray<int32>& BrickIndices)
+{
+    // Each task only writes its own brick's masks and only reads occupancy bits
+    ParallelFor(BrickIndices.Num(), [this, &BrickIndices](int32 Index)
+    {
+        RebuildBrickMasks(BrickIndices[Index]);
+    });
+}
+
+void FF12OccupancyStore::RebuildBrickMasks(int32 BrickIdx)
+{
+    const FF12OccupancyBrick& Brick = Bricks[BrickIdx];
+    FF12NeighborMaskBlock& Block = MaskBlocks[BrickIdx];
+    FMemory::Memzero(Block.Masks, sizeof(Block.Masks));
+
+    // Neighbors are at most one cell away, so they fall in the 3x3x3 bricks around this one
+    const FF12OccupancyBrick* Around[27];
+    for (int32 DZ = -1; DZ <= 1; DZ++)
+    {
+        for (int32 DY = -1; DY <= 1; DY++)
+        {
+            for (int32 DX = -1; DX <= 1; DX++)
+            {
+                Around[(DZ + 1) * 9 + (DY + 1) * 3 + (DX + 1)] = FindBrick(Brick.BrickCoord + FIntVector(DX, DY, DZ));
+            }
+        }
+    }
+
+    const FIntVector Origin = Brick.GetOrigin();
+    ForEachCellInBrick(Brick, [&](const FIntVector& Cell)
+    {
+        const FIntVector Local = Cell - Origin;
+        uint16 Mask = 0;
+
+        for (int32 Face = 0; Face < F12Lattice::NumFaces; Face++)
+        {
+            const int32 NX = Local.X + F12Lattice::NeighborOffsets[Face][0];
+            const int32 NY = Local.Y + F12Lattice::NeighborOffsets[Face][1];
+            const int32 NZ = Local.Z + F12Lattice::NeighborOffsets[Face][2];
+
+            // -1, 0 or 1 brick step per axis
+            const int32 Slot = ((NZ >> FF12OccupancyBrick::Shift) + 1) * 9 + ((NY >> FF12OccupancyBrick::Shift) + 1) * 3 + ((NX >> FF12OccupancyBrick::Shift) + 1);
+            const FF12OccupancyBrick* NeighborBrick = Around[Slot];
+
+            if (NeighborBrick && NeighborBrick->TestBit(FF12OccupancyBrick::CellToBit(
+                NX & FF12OccupancyBrick::LocalMask, NY & FF12OccupancyBrick::LocalMask, NZ & FF12OccupancyBrick::LocalMask)))
+            {
+                Mask |= 1 << Face;
+            }
+        }
+
+        Block.Get(FF12OccupancyBrick::CellToBit(Local.X, Local.Y, Local.Z)) = Mask;
+    });
+}
+
+void FF12OccupancyStore::Reset()
+{
+    Bricks.Empty();
+    FreeBricks.Empty();
+    MaskBlocks.Empty();
+    BrickLookup.Empty();
+    for (TF12FlatMap<int32>& Level : CoarseLevels)
+    {
+        Level.Empty();
+    }
+    NumOccupied = 0;
+}
+
+SIZE_T FF12OccupancyStore::GetAllocatedSize() const
+{
+    SIZE_T Size = Bricks.GetAllocatedSize() + FreeBricks.GetAllocatedSize() + MaskBlocks.GetAllocatedSize() + BrickLookup.GetAllocatedSize();
+    for (const TF12FlatMap<int32>& Level : CoarseLevels)
+    {
+        Size += Level.GetAllocatedSize();
+    }
+    return Size;
+}
+
+const FF12OccupancyBrick* FF12OccupancyStore::FindBrick(const FIntVector& BrickCoord) const
+{
+    const int32 BrickIdx = FindBrickIndex(BrickCoord);
+    return BrickIdx != INDEX_NONE ? &Bricks[BrickIdx] : nullptr;
+}
+
+void FF12OccupancyStore::GetOccupiedCells(TArray<FIntVector>& OutCells) const
+{
+    OutCells.Reserve(OutCells.Num() + NumOccupied);
+    ForEachOccupied([&OutCells](const FIntVector& Cell)
+    {
+        OutCells.Add(Cell);
+    });
+}
+
+void FF12OccupancyStore::QueryBox(const FIntVector& Min, const FIntVector& Max, TArray<FIntVector>& OutCells) const
+{
+    if (NumOccupied == 0 || Min.X > Max.X || Min.Y > Max.Y || Min.Z > Max.Z)
+        return;
+
+    const auto ClassifyBrick = [&Min, &Max](const FF12OccupancyBrick& Brick)
+    {
+        const FIntVector Lo = Brick.GetOrigin();
+        const FIntVector Hi = Lo + FIntVector(FF12OccupancyBrick::LocalMask);
+
+        if (Hi.X < Min.X || Hi.Y < Min.Y || Hi.Z < Min.Z || Lo.X > Max.X || Lo.Y > Max.Y || Lo.Z > Max.Z)
+            return EF12BrickOverlap::Outside;
+
+        if (Lo.X >= Min.X && Lo.Y >= Min.Y && Lo.Z >= Min.Z && Hi.X <= Max.X && Hi.Y <= Max.Y && Hi.Z <= Max.Z)
+            return EF12BrickOverlap::Inside;
+
+        return EF12BrickOverlap::Partial;
+    };
+
+    const auto CellFilter = [&Min, &Max](const FIntVector& Cell)
+    {
+        return Cell.X >= Min.X && Cell.Y >= Min.Y && Cell.Z >= Min.Z && Cell.X <= Max.X && Cell.Y <= Max.Y && Cell.Z <= Max.Z;
+    };
+
+    const auto AddCell = [&OutCells](const FIntVector& Cell)
+    {
+        OutCells.Add(Cell);
+    };
+
+    const FIntVector BrickMin = GetBrickCoord(Min);
+    const FIntVector BrickMax = GetBrickCoord(Max);
+    const int64 BoxBricks = int64(BrickMax.X - BrickMin.X + 1) * int64(BrickMax.Y - BrickMin.Y + 1) * int64(BrickMax.Z - BrickMin.Z + 1);
+
+    if (BoxBricks > BrickLookup.Num())
+    {
+        // Box covers more bricks than exist: scan the allocated ones
+        ForEachOccupiedCulled(ClassifyBrick, CellFilter, AddCell);
+        return;
+    }
+
+    for (int32 BZ = BrickMin.Z; BZ <= BrickMax.Z; BZ++)
+    {
+        for (int32 BY = BrickMin.Y; BY <= BrickMax.Y; BY++)
+        {
+            for (int32 BX = BrickMin.X; BX <= BrickMax.X; BX++)
+            {
+                if (const FF12OccupancyBrick* Brick = FindBrick(FIntVector(BX, BY, BZ)))
+                {
+                    VisitCulledBrick(*Brick, ClassifyBrick(*Brick), CellFilter, AddCell);
+                }
+            }
+        }
+    }
+}
+
+// === COARSE LEVELS ===
+
+void FF12OccupancyStore::AddBrickToLevels(const FIntVector& BrickCoord)
+{
+    for (int32 Level = 1; Level <= NumCoarseLevels; Level++)
+    {
+        const FIntVector NodeCoord(BrickCoord.X >> Level, BrickCoord.Y >> Level, BrickCoord.Z >> Level);
+        CoarseLevels[Level - 1].FindOrAdd(F12LatticeKey::Encode(NodeCoord))++;
+    }
+}
+
+void FF12OccupancyStore::RemoveBrickFromLevels(const FIntVector& BrickCoord)
+{
+    for (int32 Level = 1; Level <= NumCoarseLevels; Level++)
+    {
+        const FIntVector NodeCoord(BrickCoord.X >> Level, BrickCoord.Y >> Level, BrickCoord.Z >> Level);
+        const uint64 NodeKey = F12LatticeKey::Encode(NodeCoord);
+        int32* Count = CoarseLevels[Level - 1].Find(NodeKey);
+        check(Count && *Count > 0);
+        if (--(*Count) == 0)
+        {
+            CoarseLevels[Level - 1].Remove(NodeKey);
+        }
+    }
+}
+
+int32 FF12OccupancyStore::GetNodeBrickCount(int32 Level, const FIntVector& NodeCoord) const
+{
+    if (Level == 0)
+        return FindBrickIndex(NodeCoord) != INDEX_NONE ? 1 : 0;
+    if (!F12LatticeKey::IsInRange(NodeCoord))
+        return 0;
+
+    const int32* Count = CoarseLevels[Level - 1].Find(F12LatticeKey::Encode(NodeCoord));
+    return Count ? *Count : 0;
+}
+
+bool FF12OccupancyStore::AnyOccupiedInBox(const FIntVector& Min, const FIntVector& Max) const
+{
+    if (NumOccupied == 0 || Min.X > Max.X || Min.Y > Max.Y || Min.Z > Max.Z)
+        return false;
+
+    const FIntVector TopMin = GetNodeCoord(Min, NumCoarseLevels);
+    const FIntVector TopMax = GetNodeCoord(Max, NumCoarseLevels);
+    const int64 BoxNodes = int64(TopMax.X - TopMin.X + 1) * int64(TopMax.Y - TopMin.Y + 1) * int64(TopMax.Z - TopMin.Z + 1);
+    const TF12FlatMap<int32>& TopLevel = CoarseLevels[NumCoarseLevels - 1];
+
+    if (BoxNodes > TopLevel.Num())
+    {
+        // Box covers more top nodes than exist: try the existing ones
+        for (const auto& Pair : TopLevel)
+        {
+            if (AnyOccupiedInNode(NumCoarseLevels, F12LatticeKey::Decode(Pair.Key), Min, Max))
+                return true;
+        }
+        return false;
+    }
+
+    for (int32 NZ = TopMin.Z; NZ <= TopMax.Z; NZ++)
+    {
+        for (int32 NY = TopMin.Y; NY <= TopMax.Y; NY++)
+        {
+            for (int32 NX = TopMin.X; NX <= TopMax.X; NX++)
+            {
+                if (AnyOccupiedInNode(NumCoarseLevels, FIntVector(NX, NY, NZ), Min, Max))
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool FF12OccupancyStore::AnyOccupiedInNode(int32 Level, const FIntVector& NodeCoord, const FIntVector& Min, const FIntVector& Max) const
+{
+    const int32 NodeShift = FF12OccupancyBrick::Shift + Level;
+    const FIntVector Lo(NodeCoord.X << NodeShift, NodeCoord.Y << NodeShift, NodeCoord.Z << NodeShift);
+    const FIntVector Hi = Lo + FIntVector(GetNodeSize(Level) - 1);
+
+    if (Hi.X < Min.X || Hi.Y < Min.Y || Hi.Z < Min.Z || Lo.X > Max.X || Lo.Y > Max.Y || Lo.Z > Max.Z)
+        return false;
+
+    const bool bInside = Lo.X >= Min.X && Lo.Y >= Min.Y && Lo.Z >= Min.Z && Hi.X <= Max.X && Hi.Y <= Max.Y && Hi.Z <= Max.Z;
+
+    if (Level == 0)
+    {
+        const FF12OccupancyBrick* Brick = FindBrick(NodeCoord);
+        if (!Brick)
+            return false;
+        if (bInside)
+            return true;
+
+        bool bFound = false;
+        ForEachCellInBrick(*Brick, [&](const FIntVector& Cell)
+        {
+            bFound = bFound || (Cell.X >= Min.X && Cell.Y >= Min.Y && Cell.Z >= Min.Z && Cell.X <= Max.X && Cell.Y <= Max.Y && Cell.Z <= Max.Z);
+        });
+        return bFound;
+    }
+
+    if (GetNodeBrickCount(Level, NodeCoord) == 0)
+        return false;
+    if (bInside)
+        return true;
+
+    const FIntVector ChildBase(NodeCoord.X << 1, NodeCoord.Y << 1, NodeCoord.Z << 1);
+    for (int32 Child = 0; Child < 8; Child++)
+    {
+        const FIntVector ChildCoord = ChildBase + FIntVector(Child & 1, (Child >> 1) & 1, (Child >> 2) & 1);
+        if (AnyOccupiedInNode(Level - 1, ChildCoord, Min, Max))
+            return true;
+    }
+    return false;
+}
+
+int32 FF12OccupancyStore::FindEmptyLevel(const FIntVector& Cell) const
+{
+    const FIntVector BrickCoord = GetBrickCoord(Cell);
+    if (FindBrickIndex(BrickCoord) != INDEX_NONE)
+        return INDEX_NONE;
+
+    // Nothing can be stored outside the key range
+    if (!F12LatticeKey::IsInRange(BrickCoord))
+        return NumCoarseLevels;
+
+    // Parents of a non-empty node are never empty, so climb until one is
+    int32 Level = 0;
+    while (Level < NumCoarseLevels)
+    {
+        const int32 Next = Level + 1;
+        const FIntVector NodeCoord(BrickCoord.X >> Next, BrickCoord.Y >> Next, BrickCoord.Z >> Next);
+        if (CoarseLevels[Next - 1].Find(F12LatticeKey::Encode(NodeCoord)))
+            break;
+        Level = Next;
+    }
+    return Level;
+}
@@ -0,0 +1,326 @@
+// F12OccupancyStore.h
+// Sparse chunked occupancy storage for the lattice grid
+// Cells are grouped into fixed-size bricks that are only allocated when something is placed in them
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "F12FlatMap.h"
+#include "F12LatticeGeometry.h"
+
+// One brick of lattice cells (BrickSize^3) stored as a bitset.
+// Bits are parity-packed: all even-parity cells (the ones modules can occupy)
+// come first, so scans over real modules only touch the first half of the words.
+struct FF12OccupancyBrick
+{
+    static constexpr int32 Shift = 3;
+    static constexpr int32 Size = 1 << Shift;               // 8 cells per axis
+    static constexpr int32 LocalMask = Size - 1;
+    static constexpr int32 NumCells = Size * Size * Size;   // 512 cells
+    static constexpr int32 NumWords = NumCells / 64;        // 8 words
+    static constexpr int32 HalfCells = NumCells / 2;        // cells per parity class
+
+    // Brick coordinate (cell coordinate >> Shift)
+    FIntVector BrickCoord = FIntVector::ZeroValue;
+
+    // Number of occupied cells (0 = brick is on the free list)
+    int32 Count = 0;
+
+    // Occupancy bits, parity-packed (see CellToBit)
+    uint64 Words[NumWords] = {};
+
+    // Map brick-local cell coordinates (0..Size-1) to a bit index
+    static FORCEINLINE int32 CellToBit(int32 LX, int32 LY, int32 LZ)
+    {
+        const int32 Parity = (LX + LY + LZ) & 1;
+        const int32 Linear = (LZ * Size + LY) * Size + LX;
+        return Parity * HalfCells + (Linear >> 1);
+    }
+
+    // Inverse of CellToBit
+    static FORCEINLINE FIntVector BitToCell(int32 Bit)
+    {
+        const int32 Parity = Bit / HalfCells;
+        const int32 Linear = (Bit % HalfCells) << 1;
+        FIntVector Local(Linear & LocalMask, (Linear >> Shift) & LocalMask, Linear >> (2 * Shift));
+        if (((Local.X + Local.Y + Local.Z) & 1) != Parity)
+        {
+            Local.X += 1;
+        }
+        return Local;
+    }
+
+    FORCEINLINE bool TestBit(int32 Bit) const
+    {
+        return (Words[Bit >> 6] & (1ull << (Bit & 63))) != 0;
+    }
+
+    // World-cell coordinate of the first cell in this brick
+    FORCEINLINE FIntVector GetOrigin() const
+    {
+        return FIntVector(BrickCoord.X << Shift, BrickCoord.Y << Shift, BrickCoord.Z << Shift);
+    }
+};
+
+// Neighbor masks for the even-parity cells of one brick (the only ones that can be occupied).
+// Those come first in the parity-packed bits, so a cell's bit (CellToBit) is its mask index.
+// Bit F is set when the neighbor across face F (see F12Lattice) is occupied.
+// Only maintained for occupied cells; empty cells read as 0.
+struct FF12NeighborMaskBlock
+{
+    uint16 Masks[FF12OccupancyBrick::HalfCells] = {};
+
+    FORCEINLINE uint16& Get(int32 Bit)
+    {
+        checkSlow(Bit < FF12OccupancyBrick::HalfCells);
+        return Masks[Bit];
+    }
+
+    FORCEINLINE uint16 Get(int32 Bit) const
+    {
+        checkSlow(Bit < FF12OccupancyBrick::HalfCells);
+        return Masks[Bit];
+    }
+};
+
+// How a brick relates to a query region (used to cull whole bricks before testing cells)
+enum class EF12BrickOverlap : uint8
+{
+    Outside,    // No cell of the brick can match
+    Partial,    // Test cells one by one
+    Inside      // Every occupied cell of the brick matches
+};
+
+/**
+ * Sparse occupancy set for lattice cells.
+ * Only bricks that contain at least one occupied cell are allocated; empty bricks go back to a free list.
+ * Every occupied cell also carries a 12-bit neighbor mask that Set/Clear keep up to date.
+ * A solid 50^3 box (343 bricks) takes about 220 KB: 27 KB of bits, 176 KB of neighbor masks, the rest lookups.
+ */
+class FF12OccupancyStore
+{
+public:
+    // Split a cell coordinate into brick coordinate and brick-local bit
+    static FORCEINLINE FIntVector GetBrickCoord(const FIntVector& Cell)
+    {
+        // Arithmetic shift floors negative coordinates into the correct brick
+        return FIntVector(Cell.X >> FF12OccupancyBrick::Shift, Cell.Y >> FF12OccupancyBrick::Shift, Cell.Z >> FF12OccupancyBrick::Shift);
+    }
+
+    static FORCEINLINE int32 GetBitInBrick(const FIntVector& Cell)
+    {
+        return FF12OccupancyBrick::CellToBit(
+            Cell.X & FF12OccupancyBrick::LocalMask,
+            Cell.Y & FF12OccupancyBrick::LocalMask,
+            Cell.Z & FF12OccupancyBrick::LocalMask);
+    }
+
+    // Lattice points have even parity (X + Y + Z); no other cell can be set
+    static FORCEINLINE bool IsLatticeCell(const FIntVector& Cell)
+    {
+        return ((Cell.X ^ Cell.Y ^ Cell.Z) & 1) == 0;
+    }
+
+    bool IsOccupied(const FIntVector& Cell) const;
+
+    // Returns true if the cell was empty before (false for odd-parity cells)
+    bool Set(const FIntVector& Cell);
+
+    // Returns true if the cell was occupied before
+    bool Clear(const FIntVector& Cell);
+
+    // Set many cells, then recompute the neighbor masks of the touched bricks in parallel.
+    // Cells that were already set (or repeat in the input) are skipped.
+    // Returns the number of newly set cells; OutAdded receives them if given.
+    int32 SetBulk(TConstArrayView<FIntVector> Cells, TArray<FIntVector>* OutAdded = nullptr);
+
+    // Neighbor mask of an occupied cell (0 if the cell is empty)
+    uint16 GetNeighborMask(const FIntVector& Cell) const;
+
+    // Probe the 12 neighbors directly (works for empty cells too)
+    uint16 ComputeNeighborMask(const FIntVector& Cell) const;
+
+    // Recompute every neighbor mask from the occupancy bits (parallel over bricks)
+    void RebuildNeighborMasks();
+
+    // Remove everything and release all bricks
+    void Reset();
+
+    // Number of occupied cells
+    int32 Num() const { return NumOccupied; }
+
+    // Number of allocated (non-empty) bricks
+    int32 NumBricks() const { return BrickLookup.Num(); }
+
+    // Bytes used by the brick storage and lookup
+    SIZE_T GetAllocatedSize() const;
+
+    // Find a brick by brick coordinate (nullptr if not allocated)
+    const FF12OccupancyBrick* FindBrick(const FIntVector& BrickCoord) const;
+
+    // Append every occupied cell
+    void GetOccupiedCells(TArray<FIntVector>& OutCells) const;
+
+    // Visit every allocated brick: Func(const FF12OccupancyBrick&)
+    template <typename FuncType>
+    void ForEachBrick(FuncType&& Func) const
+    {
+        for (const FF12OccupancyBrick& Brick : Bricks)
+        {
+            if (Brick.Count > 0)
+            {
+                Func(Brick);
+            }
+        }
+    }
+
+    // Visit every occupied cell in a brick: Func(const FIntVector& Cell)
+    template <typename FuncType>
+    static void ForEachCellInBrick(const FF12OccupancyBrick& Brick, FuncType&& Func)
+    {
+        // Only even-parity cells can be set, and they fill the first half of the words
+        const FIntVector Origin = Brick.GetOrigin();
+        for (int32 WordIdx = 0; WordIdx < FF12OccupancyBrick::NumWords / 2; WordIdx++)
+        {
+            uint64 Word = Brick.Words[WordIdx];
+            while (Word)
+            {
+                const int32 Bit = WordIdx * 64 + (int32)FMath::CountTrailingZeros64(Word);
+                Word &= Word - 1;
+                Func(Origin + FF12OccupancyBrick::BitToCell(Bit));
+            }
+        }
+    }
+
+    // Visit every occupied cell: Func(const FIntVector& Cell)
+    template <typename FuncType>
+    void ForEachOccupied(FuncType&& Func) const
+    {
+        ForEachBrick([&Func](const FF12OccupancyBrick& Brick)
+        {
+            ForEachCellInBrick(Brick, Func);
+        });
+    }
+
+    // Visit the occupied cells of a region, culling whole bricks first.
+    // ClassifyBrick(const FF12OccupancyBrick&) returns an EF12BrickOverlap; only cells of
+    // Partial bricks go through CellFilter(const FIntVector&) -> bool before Func(const FIntVector&).
+    template <typename ClassifyType, typename CellFilterType, typename FuncType>
+    void ForEachOccupiedCulled(ClassifyType&& ClassifyBrick, CellFilterType&& CellFilter, FuncType&& Func) const
+    {
+        ForEachBrick([&](const FF12OccupancyBrick& Brick)
+        {
+            VisitCulledBrick(Brick, ClassifyBrick(Brick), CellFilter, Func);
+        });
+    }
+
+    // Append the occupied cells inside the inclusive cell box [Min, Max].
+    // Small boxes look up only the bricks they overlap; large ones scan the allocated bricks,
+    // so the cost follows min(box volume, occupancy) rather than the box volume.
+    void QueryBox(const FIntVector& Min, const FIntVector& Max, TArray<FIntVector>& OutCells) const;
+
+    // === COARSE LEVELS ===
+    // Level 0 is the bricks themselves; a node at level L covers 2^L bricks per axis.
+    // Coarse nodes count the allocated bricks below them and follow every brick allocation
+    // and release, so "is anything here" questions cost one lookup per level.
+
+    static constexpr int32 NumCoarseLevels = 8;
+
+    // Node containing a cell at the given level
+    static FORCEINLINE FIntVector GetNodeCoord(const FIntVector& Cell, int32 Level)
+    {
+        const int32 NodeShift = FF12OccupancyBrick::Shift + Level;
+        return FIntVector(Cell.X >> NodeShift, Cell.Y >> NodeShift, Cell.Z >> NodeShift);
+    }
+
+    // Cells per axis covered by a node at the given level
+    static FORCEINLINE int32 GetNodeSize(int32 Level)
+    {
+        return FF12OccupancyBrick::Size << Level;
+    }
+
+    // Allocated bricks under a node (level 0: 1 if the brick exists, else 0)
+    int32 GetNodeBrickCount(int32 Level, const FIntVector& NodeCoord) const;
+
+    // Visit every non-empty node of a level: Func(const FIntVector& NodeCoord, int32 BrickCount)
+    template <typename FuncType>
+    void ForEachNode(int32 Level, FuncType&& Func) const
+    {
+        if (Level == 0)
+        {
+            ForEachBrick([&Func](const FF12OccupancyBrick& Brick)
+            {
+                Func(Brick.BrickCoord, 1);
+            });
+            return;
+        }
+
+        CoarseLevels[Level - 1].ForEach([&Func](uint64 Key, int32 BrickCount)
+        {
+            Func(F12LatticeKey::Decode(Key), BrickCount);
+        });
+    }
+
+    // Is any cell in the inclusive box [Min, Max] occupied? Descends from the coarsest level
+    // and stops at the first node that is non-empty and fully inside the box.
+    bool AnyOccupiedInBox(const FIntVector& Min, const FIntVector& Max) const;
+
+    // Highest level whose node around Cell has no bricks at all,
+    // or INDEX_NONE if Cell's own brick is allocated
+    int32 FindEmptyLevel(const FIntVector& Cell) const;
+
+private:
+    template <typename CellFilterType, typename FuncType>
+    static void VisitCulledBrick(const FF12OccupancyBrick& Brick, EF12BrickOverlap Overlap, CellFilterType& CellFilter, FuncType& Func)
+    {
+        if (Overlap == EF12BrickOverlap::Inside)
+        {
+            ForEachCellInBrick(Brick, Func);
+        }
+        else if (Overlap == EF12BrickOverlap::Partial)
+        {
+            ForEachCellInBrick(Brick, [&](const FIntVector& Cell)
+            {
+                if (CellFilter(Cell))
+                {
+                    Func(Cell);
+                }
+            });
+        }
+    }
+
+    // Index into Bricks, or INDEX_NONE if the brick is not allocated
+    int32 FindBrickIndex(const FIntVector& BrickCoord) const;
+
+    // Find or allocate the brick for a brick coordinate
+    int32 FindOrAddBrick(const FIntVector& BrickCoord);
+
+    // Set the occupancy bit only (no mask update). Returns true if the cell was empty.
+    bool SetBit(const FIntVector& Cell, int32& OutBrickIdx);
+
+    // Recompute the masks of every occupied cell in one brick
+    void RebuildBrickMasks(int32 BrickIdx);
+
+    void RebuildNeighborMasksForBricks(const TArray<int32>& BrickIndices);
+
+    // Dense brick storage; freed slots are recycled through FreeBricks
+    TArray<FF12OccupancyBrick> Bricks;
+    TArray<int32> FreeBricks;
+
+    // Neighbor masks, parallel to Bricks (kept apart so bitset scans stay compact)
+    TArray<FF12NeighborMaskBlock> MaskBlocks;
+
+    // Lattice key of the brick coordinate -> index into Bricks
+    TF12FlatMap<int32> BrickLookup;
+
+    // Keep the coarse node counts in step with brick allocation
+    void AddBrickToLevels(const FIntVector& BrickCoord);
+    void RemoveBrickFromLevels(const FIntVector& BrickCoord);
+
+    bool AnyOccupiedInNode(int32 Level, const FIntVector& NodeCoord, const FIntVector& Min, const FIntVector& Max) const;
+
+    // Lattice key of the node coordinate -> allocated bricks below it, for levels 1..NumCoarseLevels
+    TF12FlatMap<int32> CoarseLevels[NumCoarseLevels];
+
+    int32 NumOccupied = 0;
+};
@@ -45,6 +45,9 @@ FF12GenerationResult UF12ProceduralGenerator::Generate(const FF12GenerationParam
         return Result;
     }
 
+    // Clearing and adding commit to the renderer together at the end of the function
+    FF12ScopedEditBatch Batch(Renderer);
+
     // Clear existing if requested
     if (Params.bClearExisting)
     {
@@ -66,30 +69,28 @@ FF12GenerationResult UF12ProceduralGenerator::Generate(const FF12GenerationParam
     }
 
     // Filter valid coordinates
-    TArray<FF12GridCoord> ValidCoords;
+    TArray<FF12GridCoord> CandidateCoords;
+    CandidateCoords.Reserve(Coords.Num());
     
     for (const FF12GridCoord& Coord : Coords)
     {
-        // Skip if occupied
-        if (GridSystem->IsOccupied(Coord))
-        {
-            Result.ModulesSkipped++;
-            continue;
-        }
-
         // Skip core if preserving
         if (Params.bPreserveCore && Coord.X == 0 && Coord.Y == 0 && Coord.Z == 0)
         {
-            Result.ModulesSkipped++;
             continue;
         }
 
-        ValidCoords.Add(Coord);
-        GridSystem->SetOccupied(Coord, nullptr);
-        Result.CreatedCoords.Add(Coord);
-        Result.ModulesCreated++;
+        CandidateCoords.Add(Coord);
     }
 
+    // Occupy in one pass (skips occupied cells and duplicates, neighbor masks updated once)
+    TArray<FF12GridCoord> ValidCoords;
+    GridSystem->SetOccupiedBulk(CandidateCoords, ValidCoords);
+
+    Result.CreatedCoords = ValidCoords;
+    Result.ModulesCreated = ValidCoords.Num();
+    Result.ModulesSkipped = Coords.Num() - ValidCoords.Num();
+
     // Determine material index
     int32 MatIdx = 0;
     if (Params.MaterialIndex >= 0)
@@ -140,37 +141,39 @@ int32 UF12ProceduralGenerator::ClearRegion(FIntVector MinCoord, FIntVector MaxCo
     if (!GridSystem || !Controller || !Controller->InstancedRenderer)
         return 0;
 
-    int32 Cleared = 0;
-
-    for (int32 X = MinCoord.X; X <= MaxCoord.X; X++)
-    {
-        for (int32 Y = MinCoord.Y; Y <= MaxCoord.Y; Y++)
-        {
-            for (int32 Z = MinCoord.Z; Z <= MaxCoord.Z; Z++)
-            {
-                // Skip core if preserving
-                if (bPreserveCore && X == 0 && Y == 0 && Z == 0)
-                    continue;
+    // Nothing to do for untouched space (e.g. generating somewhere new)
+    if (GridSystem->IsRegionEmpty(FF12GridCoord(MinCoord), FF12GridCoord(MaxCoord)))
+        return 0;
 
-                FF12GridCoord Coord(X, Y, Z);
-                
-                if (GridSystem->IsOccupied(Coord))
-                {
-                    Controller->InstancedRenderer->RemoveModule(Coord);
-                    GridSystem->ClearOccupied(Coord);
-                    Cleared++;
-                }
-            }
-        }
-    }
+    // Only visits bricks that overlap the region
+    TArray<FF12GridCoord> ToClear;
+    GridSystem->QueryBox(FF12GridCoord(MinCoord), FF12GridCoord(MaxCoord), ToClear);
 
-    UE_LOG(LogTemp, Log, TEXT("Cleared %d modules in region"), Cleared);
-    return Cleared;
+    return ClearModules(ToClear, bPreserveCore);
 }
 
 int32 UF12ProceduralGenerator::ClearAll(bool bPreserveCore)
 {
-    return ClearRegion(FIntVector(-100, -100, -100), FIntVector(100, 100, 100), bPreserveCore);
+    if (!GridSystem || !Controller || !Controller->InstancedRenderer)
+        return 0;
+
+    return ClearModules(GridSystem->GetOccupiedCells(), bPreserveCore);
+}
+
+int32 UF12ProceduralGenerator::ClearModules(TArray<FF12GridCoord> ToClear, bool bPreserveCore)
+{
+    // Skip core if preserving
+    if (bPreserveCore)
+    {
+        ToClear.RemoveSingleSwap(FF12GridCoord(0, 0, 0), EAllowShrinking::No);
+    }
+
+    // Remove in one batch: one instance rebuild and one connectivity update for the region
+    Controller->InstancedRenderer->RemoveModulesBulk(ToClear);
+    const int32 Cleared = GridSystem->ClearOccupiedBulk(ToClear);
+
+    UE_LOG(LogTemp, Log, TEXT("Cleared %d modules"), Cleared);
+    return Cleared;
 }
 
 int32 UF12ProceduralGenerator::EstimateModuleCount(const FF12GenerationParams& Params)
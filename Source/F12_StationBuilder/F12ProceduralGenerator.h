@@ -134,6 +134,9 @@ protected:
     UPROPERTY()
     AF12BuilderController* Controller;
 
+    // Remove the given occupied modules from renderer and grid in one batch
+    int32 ClearModules(TArray<FF12GridCoord> ToClear, bool bPreserveCore);
+
     // Shape generation functions - return list of coordinates to fill
     TArray<FF12GridCoord> GenerateHollowBoxCoords(const FF12GenerationParams& Params);
     TArray<FF12GridCoord> GenerateSolidBoxCoords(const FF12GenerationParams& Params);
@@ -0,0 +1,122 @@
+// F12StationSnapshot.cpp
+// Implementation of the copy-on-write station snapshots
+
+#include "F12StationSnapshot.h"
+
+// === SNAPSHOT ===
+
+const FF12SnapshotChunk* FF12StationSnapshot::FindChunk(const FIntVector& BrickCoord) const
+{
+    if (!F12LatticeKey::IsInRange(BrickCoord))
+        return nullptr;
+
+    const FPagePtr* Page = Pages.Find(F12LatticeKey::Encode(GetPageCoord(BrickCoord)));
+    if (!Page)
+        return nullptr;
+
+    const FF12SnapshotChunkPtr* Chunk = (*Page)->Chunks.Find(F12LatticeKey::Encode(BrickCoord));
+    return Chunk ? Chunk->Get() : nullptr;
+}
+
+bool FF12StationSnapshot::IsOccupied(const FIntVector& Cell) const
+{
+    const FF12SnapshotChunk* Chunk = FindChunk(FF12OccupancyStore::GetBrickCoord(Cell));
+    return Chunk && Chunk->Cells.TestBit(FF12OccupancyStore::GetBitInBrick(Cell));
+}
+
+const FF12SnapshotModule* FF12StationSnapshot::FindModule(const FIntVector& Cell) const
+{
+    const FF12SnapshotChunk* Chunk = FindChunk(FF12OccupancyStore::GetBrickCoord(Cell));
+    return Chunk ? Chunk->Find(FF12OccupancyStore::GetBitInBrick(Cell)) : nullptr;
+}
+
+// === PUBLISHER ===
+
+FF12SnapshotPublisher::FF12SnapshotPublisher()
+    : Latest(MakeShared<FF12StationSnapshot, ESPMode::ThreadSafe>())
+{
+}
+
+void FF12SnapshotPublisher::MarkDirty(const FIntVector& Cell)
+{
+    DirtyBricks.FindOrAdd(F12LatticeKey::Encode(FF12OccupancyStore::GetBrickCoord(Cell)));
+}
+
+void FF12SnapshotPublisher::MarkCleared()
+{
+    bClearPending = true;
+    DirtyBricks.Reset();
+}
+
+int32 FF12SnapshotPublisher::Publish(TFunctionRef<void(const FIntVector&, FF12SnapshotChunk&)> FillChunk)
+{
+    if (!HasPendingChanges())
+        return 0;
+
+    // Start from the previous version's page table; pages themselves are shared until touched
+    TSharedRef<FF12StationSnapshot, ESPMode::ThreadSafe> Next = MakeShared<FF12StationSnapshot, ESPMode::ThreadSafe>();
+    Next->Version = Latest->Version + 1;
+    if (!bClearPending)
+    {
+        Next->Pages = Latest->Pages;
+        Next->NumModules = Latest->NumModules;
+        Next->NumChunksTotal = Latest->NumChunksTotal;
+    }
+
+    // Group the dirty bricks by page so every touched page is copied once
+    TF12FlatMap<TArray<FIntVector>> DirtyByPage;
+    DirtyBricks.ForEach([&DirtyByPage](uint64 BrickKey, uint8)
+    {
+        const FIntVector BrickCoord = F12LatticeKey::Decode(BrickKey);
+        DirtyByPage.FindOrAdd(F12LatticeKey::Encode(FF12StationSnapshot::GetPageCoord(BrickCoord))).Add(BrickCoord);
+    });
+
+    int32 NumRebuilt = 0;
+    for (const auto& PagePair : DirtyByPage)
+    {
+        TSharedRef<FF12StationSnapshot::FPage, ESPMode::ThreadSafe> Page = MakeShared<FF12StationSnapshot::FPage, ESPMode::ThreadSafe>();
+        if (const FF12StationSnapshot::FPagePtr* OldPage = Next->Pages.Find(PagePair.Key))
+        {
+            Page->Chunks = (*OldPage)->Chunks;
+        }
+
+        for (const FIntVector& BrickCoord : PagePair.Value)
+        {
+            const uint64 BrickKey = F12LatticeKey::Encode(BrickCoord);
+
+            FF12SnapshotChunkPtr OldChunk;
+            if (Page->Chunks.RemoveAndCopyValue(BrickKey, OldChunk))
+            {
+                Next->NumModules -= OldChunk->Cells.Count;
+                Next->NumChunksTotal--;
+            }
+
+            TSharedRef<FF12SnapshotChunk, ESPMode::ThreadSafe> Chunk = MakeShared<FF12SnapshotChunk, ESPMode::ThreadSafe>();
+            Chunk->Cells.BrickCoord = BrickCoord;
+            FillChunk(BrickCoord, *Chunk);
+            NumRebuilt++;
+
+            if (Chunk->Cells.Count > 0)
+            {
+                check(Chunk->Modules.Num() == Chunk->Cells.Count);
+                Next->NumModules += Chunk->Cells.Count;
+                Next->NumChunksTotal++;
+                Page->Chunks.Add(BrickKey, FF12SnapshotChunkPtr(Chunk));
+            }
+        }
+
+        if (Page->Chunks.Num() > 0)
+        {
+            Next->Pages.Add(PagePair.Key, FF12StationSnapshot::FPagePtr(Page));
+        }
+        else
+        {
+            Next->Pages.Remove(PagePair.Key);
+        }
+    }
+
+    DirtyBricks.Reset();
+    bClearPending = false;
+    Latest = Next;
+    return NumRebuilt;
+}
@@ -0,0 +1,192 @@
+// F12StationSnapshot.h
+// Immutable, versioned copies of the station (occupancy + tile data) for worker-thread readers
+// Chunks are shared between versions; publishing only rebuilds the chunks that changed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/SharedPointer.h"
+#include "F12FlatMap.h"
+#include "F12OccupancyStore.h"
+
+// Free per-tile paint: sRGB colour + roughness in 32 bits (R | G << 8 | B << 16 | Roughness << 24)
+namespace F12TilePaint
+{
+    inline uint32 Pack(const FLinearColor& Color, float Roughness)
+    {
+        const FColor SRGB = Color.ToFColor(true);
+        const uint32 RoughnessByte = (uint32)FMath::RoundToInt(FMath::Clamp(Roughness, 0.0f, 1.0f) * 255.0f);
+        return (uint32)SRGB.R | ((uint32)SRGB.G << 8) | ((uint32)SRGB.B << 16) | (RoughnessByte << 24);
+    }
+
+    inline FLinearColor UnpackColor(uint32 Packed)
+    {
+        return FLinearColor(FColor((uint8)(Packed & 0xFF), (uint8)((Packed >> 8) & 0xFF), (uint8)((Packed >> 16) & 0xFF)));
+    }
+
+    inline float UnpackRoughness(uint32 Packed)
+    {
+        return (float)(Packed >> 24) / 255.0f;
+    }
+}
+
+// Tile data of one module as seen by a snapshot
+struct FF12SnapshotModule
+{
+    // Material index per tile
+    uint8 TileMaterials[F12Lattice::NumFaces] = {};
+
+    // Bit N set = tile N visible
+    uint16 VisibleTiles = F12Lattice::AllFacesMask;
+
+    // Bit N set = tile N uses TileColors[N] instead of its material
+    uint16 ColoredTiles = 0;
+
+    // Packed with F12TilePaint::Pack
+    uint32 TileColors[F12Lattice::NumFaces] = {};
+};
+
+// One brick of the station: occupancy bits plus the tile data of its occupied cells
+struct FF12SnapshotChunk
+{
+    // Same bits and brick coordinate as the occupancy store's brick
+    FF12OccupancyBrick Cells;
+
+    // One entry per occupied cell, in bit order (see Find)
+    TArray<FF12SnapshotModule> Modules;
+
+    // Tile data for a brick-local bit (nullptr if the cell is empty)
+    const FF12SnapshotModule* Find(int32 Bit) const
+    {
+        if (!Cells.TestBit(Bit))
+            return nullptr;
+
+        // Rank of the bit = number of occupied cells before it
+        const int32 WordIdx = Bit >> 6;
+        int32 Rank = (int32)FMath::CountBits(Cells.Words[WordIdx] & ((1ull << (Bit & 63)) - 1));
+        for (int32 i = 0; i < WordIdx; i++)
+        {
+            Rank += (int32)FMath::CountBits(Cells.Words[i]);
+        }
+        return &Modules[Rank];
+    }
+};
+
+using FF12SnapshotChunkPtr = TSharedPtr<const FF12SnapshotChunk, ESPMode::ThreadSafe>;
+
+/**
+ * A consistent, read-only view of the station at one point in time.
+ * Safe to read from any thread; holding a reference keeps its chunks alive.
+ *
+ * Chunks are grouped into pages (PageShift bricks per axis) so that publishing a new
+ * version copies only the page table and the pages that contain changed chunks.
+ */
+class FF12StationSnapshot
+{
+public:
+    // Bricks per page axis = 1 << PageShift
+    static constexpr int32 PageShift = 3;
+
+    struct FPage
+    {
+        // Brick lattice key -> chunk
+        TF12FlatMap<FF12SnapshotChunkPtr> Chunks;
+    };
+
+    using FPagePtr = TSharedPtr<const FPage, ESPMode::ThreadSafe>;
+
+    // Increases with every publish (0 = nothing published yet)
+    uint64 GetVersion() const { return Version; }
+
+    // Number of occupied cells
+    int32 Num() const { return NumModules; }
+
+    int32 NumChunks() const { return NumChunksTotal; }
+
+    bool IsOccupied(const FIntVector& Cell) const;
+
+    // Tile data of an occupied cell (nullptr if empty)
+    const FF12SnapshotModule* FindModule(const FIntVector& Cell) const;
+
+    const FF12SnapshotChunk* FindChunk(const FIntVector& BrickCoord) const;
+
+    // Visit every chunk: Func(const FF12SnapshotChunk&)
+    template <typename FuncType>
+    void ForEachChunk(FuncType&& Func) const
+    {
+        for (const auto& PagePair : Pages)
+        {
+            for (const auto& ChunkPair : PagePair.Value->Chunks)
+            {
+                Func(*ChunkPair.Value);
+            }
+        }
+    }
+
+    // Visit every occupied cell: Func(const FIntVector& Cell, const FF12SnapshotModule& Module)
+    template <typename FuncType>
+    void ForEachModule(FuncType&& Func) const
+    {
+        ForEachChunk([&Func](const FF12SnapshotChunk& Chunk)
+        {
+            int32 Index = 0;
+            FF12OccupancyStore::ForEachCellInBrick(Chunk.Cells, [&](const FIntVector& Cell)
+            {
+                Func(Cell, Chunk.Modules[Index++]);
+            });
+        });
+    }
+
+    static FIntVector GetPageCoord(const FIntVector& BrickCoord)
+    {
+        return FIntVector(BrickCoord.X >> PageShift, BrickCoord.Y >> PageShift, BrickCoord.Z >> PageShift);
+    }
+
+private:
+    friend class FF12SnapshotPublisher;
+
+    uint64 Version = 0;
+    int32 NumModules = 0;
+    int32 NumChunksTotal = 0;
+
+    // Page lattice key -> page
+    TF12FlatMap<FPagePtr> Pages;
+};
+
+using FF12StationSnapshotRef = TSharedRef<const FF12StationSnapshot, ESPMode::ThreadSafe>;
+
+/**
+ * Game-thread side of the snapshots: collects changed bricks and publishes new versions.
+ *
+ * Call MarkDirty for every cell whose occupancy or tiles changed, then Publish once per frame.
+ * GetLatest is game-thread only; pass the returned reference to the worker that needs it.
+ */
+class FF12SnapshotPublisher
+{
+public:
+    FF12SnapshotPublisher();
+
+    // The brick containing Cell must be rebuilt on the next publish
+    void MarkDirty(const FIntVector& Cell);
+
+    // Drop every chunk on the next publish (rebuilding only what is marked dirty afterwards)
+    void MarkCleared();
+
+    bool HasPendingChanges() const { return bClearPending || DirtyBricks.Num() > 0; }
+
+    // Build the next version if anything changed.
+    // FillChunk(const FIntVector& BrickCoord, FF12SnapshotChunk& OutChunk) fills the chunk's bits and
+    // modules for a dirty brick; a chunk left with Cells.Count == 0 is dropped.
+    // Returns the number of chunks rebuilt.
+    int32 Publish(TFunctionRef<void(const FIntVector&, FF12SnapshotChunk&)> FillChunk);
+
+    FF12StationSnapshotRef GetLatest() const { return Latest; }
+
+private:
+    // Brick lattice keys marked since the last publish (value unused)
+    TF12FlatMap<uint8> DirtyBricks;
+
+    bool bClearPending = false;
+
+    FF12StationSnapshotRef Latest;
+};